@@ -0,0 +1,134 @@
+const fs = require("fs").promises;
+const os = require("os");
+const path = require("path");
+const {promisify} = require("util");
+const exec = promisify(require("child_process").exec);
+const {performance} = require("perf_hooks");
+
+// Compares the solver's scalar and -msimd128 builds under node, which runs
+// WebAssembly SIMD natively. Both are built here for node from the worker
+// build's sources at -O3, so the only difference is the vector
+// instructions.
+//
+//   node scripts/bench_simd [--budget nodes] [--filter name] [--no-build]
+const option = (name, fallback) => {
+  const i = process.argv.indexOf(name);
+  return i < 0 ? fallback : process.argv[i + 1];
+};
+const budget = +option("--budget", 200000);
+const filter = option("--filter", "");
+const build = !process.argv.includes("--no-build");
+
+// Out of dist, which deploys whole
+const out = path.join(os.tmpdir(), "sokoban_bench");
+const variants = [
+  {name: "scalar", flags: "-O3"},
+  {name: "simd", flags: "-O3 -msimd128"},
+];
+
+const emcc = ({name, flags}) => `
+  emcc src/engine/worker.cpp src/engine/bitboard.cpp src/engine/hint.cpp
+  src/engine/maze.cpp src/engine/solver.cpp src/engine/trace.cpp
+  src/engine/worker_pool.cpp
+  -std=c++1z -fexceptions
+  -o ${out}/solver_${name}.js
+  -s ENVIRONMENT=node
+  -s MODULARIZE=1
+  -s NO_EXIT_RUNTIME=1
+  -s ALLOW_MEMORY_GROWTH=1
+  -s "EXPORTED_FUNCTIONS=['_main', '_solver_start', '_solver_run',
+    '_solver_nodes', '_solver_stop']"
+  -s "EXPORTED_RUNTIME_METHODS=['cwrap']"
+  ${flags}
+`.replace(/\n/g, " ");
+
+/**
+ * Read the board of each level file, in name order
+ * @param string dir the directory of .xsb files
+ * @return Promise<Array<{name, board}>> the boards as newline-joined rows
+*/
+const readLevels = async dir => {
+  const files = (await fs.readdir(dir)).filter(f => f.endsWith(".xsb"));
+  const levels = [];
+
+  for (const file of files.sort()) {
+    const text = await fs.readFile(path.join(dir, file), "utf8");
+    const rows = text.split(/\r?\n/);
+    const end = rows.findIndex(row => !/^[ #@+$*.]*#[ #@+$*.]*$/.test(row));
+    levels.push({
+      name: path.basename(file, ".xsb"),
+      board: rows.slice(0, end < 0 ? rows.length : end).join("\n"),
+    });
+  }
+
+  return levels.filter(({name}) => name.includes(filter));
+};
+
+/**
+ * Time a first-solution search of each board, up to the node budget
+ * @param string script the variant's build
+ * @param Array levels the boards to search
+ * @return Promise<Array<{ms, nodes}>> the time and nodes for each board
+*/
+const run = async (script, levels) => {
+  const Module = await require(path.resolve(script))();
+  const start = Module.cwrap("solver_start", "bool",
+    ["string", "number", "bool", "number"]);
+  const search = Module.cwrap("solver_run", "number", ["number"]);
+  const nodes = Module.cwrap("solver_nodes", "number");
+  const stop = Module.cwrap("solver_stop");
+  const results = [];
+
+  for (const {board} of levels) {
+    const before = performance.now();
+    start(board, 3, true, 1);
+    search(budget);
+    results.push({ms: performance.now() - before, nodes: nodes()});
+    stop();
+  }
+
+  return results;
+};
+
+const pad = (value, width) => String(value).padStart(width);
+
+(async () => {
+  if (build) {
+    await fs.mkdir(out, {recursive: true});
+
+    for (const variant of variants) {
+      try {
+        await exec(emcc(variant));
+      }
+      catch (err) {
+        console.error(err.message);
+        process.exit(1);
+      }
+    }
+  }
+
+  const levels = await readLevels(path.join("src", "engine", "levels"));
+  const times = {};
+
+  for (const {name} of variants) {
+    times[name] = await run(path.join(out, `solver_${name}.js`), levels);
+  }
+
+  console.log(`${"level".padEnd(12)}${pad("nodes", 10)}` +
+    `${pad("scalar ms", 12)}${pad("simd ms", 12)}${pad("speedup", 10)}`);
+  const totals = {scalar: 0, simd: 0};
+
+  levels.forEach(({name}, i) => {
+    const a = times.scalar[i];
+    const b = times.simd[i];
+    totals.scalar += a.ms;
+    totals.simd += b.ms;
+    console.log(`${name.padEnd(12)}${pad(a.nodes, 10)}` +
+      `${pad(a.ms.toFixed(1), 12)}${pad(b.ms.toFixed(1), 12)}` +
+      `${pad((a.ms / b.ms).toFixed(2) + "x", 10)}`);
+  });
+
+  console.log(`${"total".padEnd(22)}${pad(totals.scalar.toFixed(0), 12)}` +
+    `${pad(totals.simd.toFixed(0), 12)}` +
+    `${pad((totals.scalar / totals.simd).toFixed(2) + "x", 10)}`);
+})();
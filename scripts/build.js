@@ -1,39 +1,157 @@
 const fs = require("fs").promises;
 const path = require("path");
-const {exec} = require("child_process");
+const {promisify} = require("util");
+const exec = promisify(require("child_process").exec);
 const cp = require("./cp");
 
-const emcc = `
-  emcc src/engine/main.cpp src/engine/sokoban.cpp
-  -std=c++1z
-  -o dist/sokoban.js 
+// The engine reports bad input by throwing std::invalid_argument, and the
+// C API catches it to return false, 0 or "". Emscripten aborts on any
+// throw unless exception catching is compiled in, so every build needs it.
+const exceptions = "-fexceptions";
+
+// The level packer runs under node at build time with direct file access
+const packer = `
+  emcc src/tools/pack_levels.cpp src/engine/level_pack.cpp
+  src/engine/level_parser.cpp
+  -std=c++1z ${exceptions}
+  -o dist/pack_levels.js
+  -s NODERAWFS=1
+`.replace(/\n/g, " ");
+
+// Embedded builds compile the levels in instead of fetching a pack
+const embed = process.argv.includes("--embed");
+const pack = embed
+  ? "node dist/pack_levels.js --embed src/engine/levels " +
+    "dist/embedded_level_data.cpp"
+  : "node dist/pack_levels.js src/engine/levels dist/levels.pack";
+const levelData = embed
+  ? "dist/embedded_level_data.cpp -Isrc/engine"
+  : "src/engine/embedded_level_data.cpp";
+
+// The production profile optimizes the page's build for size, since its
+// calls are cheap and its download and compile are what delay the first
+// move, and the worker builds for speed. It also exports only main.cpp's
+// C API, where development builds export everything for the console.
+const production = process.argv.includes("--production");
+const api = require("fs").readFileSync("src/engine/main.cpp", "utf8")
+  .split('extern "C" {')[1].split('} // extern "C"')[0]
+  .match(/^\S.*?\b\w+(?=\()/gm)
+  .map(declaration => `'_${declaration.match(/\w+$/)[0]}'`);
+const pageProfile = production
+  ? `-Oz -flto -s ENVIRONMENT=web
+    -s "EXPORTED_FUNCTIONS=['_main', ${api.join(", ")}]"`
+  : "-s LINKABLE=1 -s EXPORT_ALL=1";
+const workerProfile = production ? "-O3 -flto" : "";
+
+// --stats compiles in the engine's and the solver's counters, which
+// soko.stats() and the worker's results report, and their trace events;
+// without it they cost nothing, the counters read as zeros and traces
+// are empty
+const stats = process.argv.includes("--stats") ? "-DSOKOBAN_STATS" : "";
+
+// Each build has a SIMD variant, compiled with -msimd128 so the Bitboard
+// loops in the searches run as WebAssembly vector instructions. Pages pick
+// it when the browser validates a SIMD module and the scalar build if not.
+// Only optimized builds run the loop vectorizer, so development's SIMD
+// variants are -O3; in production each keeps its profile's level, -Oz for
+// the page, whose download matters most, and -O3 for the worker.
+const simd = production ? "-msimd128" : "-msimd128 -O3";
+
+// The page's build is modularized: soko.js calls createSokoban, which
+// compiles the .wasm as it streams in while the page fetches the index of
+// levels.pack beside it, and writes it into the file system before
+// initializing; each level's cells follow when it's first played
+const emcc = (output, flags = "") => `
+  emcc src/engine/main.cpp src/engine/sokoban.cpp src/engine/bitboard.cpp
+  src/engine/embedded_levels.cpp src/engine/hint.cpp
+  src/engine/level_pack.cpp src/engine/level_parser.cpp
+  src/engine/level_store.cpp src/engine/maze.cpp
+  src/engine/move_sequence.cpp src/engine/session_pool.cpp
+  src/engine/solver.cpp src/engine/trace.cpp src/engine/undo_tree.cpp
+  src/engine/worker_pool.cpp ${levelData}
+  -std=c++1z ${exceptions}
+  -o dist/${output}
+  -s NO_EXIT_RUNTIME=1
+  -s MODULARIZE=1
+  -s EXPORT_NAME=createSokoban
+  -s FORCE_FILESYSTEM=1
+  -s "EXPORTED_RUNTIME_METHODS=['ccall', 'cwrap', 'FS', 'HEAPU8']"
+  ${pageProfile}
+  ${stats}
+  ${flags}
+`.replace(/\n/g, " ");
+
+// A second build with only the searches, loaded by a Web Worker so solving
+// and hinting never block the game on the main thread. The threaded variant
+// runs the solver's successor generation on a pool of pthreads sized to the
+// machine, and is only used on cross-origin isolated pages.
+const threads = process.argv.includes("--threads");
+const emccWorker = (output, flags = "") => `
+  emcc src/engine/worker.cpp src/engine/bitboard.cpp src/engine/hint.cpp
+  src/engine/maze.cpp src/engine/solver.cpp src/engine/trace.cpp
+  src/engine/worker_pool.cpp
+  -std=c++1z ${exceptions}
+  -o dist/${output}
+  -s ENVIRONMENT=worker
   -s NO_EXIT_RUNTIME=1
-  -s LINKABLE=1
-  -s EXPORT_ALL=1
-  -s "EXPORTED_RUNTIME_METHODS=['ccall', 'cwrap']"
-  --preload-file "src/engine/levels"
+  -s ALLOW_MEMORY_GROWTH=1
+  -s "EXPORTED_FUNCTIONS=['_main', '_solver_start', '_solver_run',
+    '_solver_nodes', '_solver_bound', '_solver_optimal', '_solver_solution',
+    '_solver_stats', '_solver_stop', '_solver_trace_start',
+    '_solver_trace_stop', '_worker_hint']"
+  -s "EXPORTED_RUNTIME_METHODS=['cwrap']"
+  ${workerProfile}
+  ${stats}
+  ${flags}
 `.replace(/\n/g, " ");
+const pthreads = "-pthread -s PTHREAD_POOL_SIZE=navigator.hardwareConcurrency";
+const builds = [
+  emcc("sokoban.js"),
+  emcc("sokoban_simd.js", simd),
+  emccWorker("sokoban_worker.js"),
+  emccWorker("sokoban_worker_simd.js", simd),
+];
+
+if (threads) {
+  builds.push(
+    emccWorker("sokoban_worker_threads.js", pthreads),
+    emccWorker("sokoban_worker_threads_simd.js", `${pthreads} ${simd}`)
+  );
+}
 
 const src = path.join("src", "ui");
 const dist = "dist";
 
 (async () => {
   await fs.mkdir(dist).catch(err => {});
-  exec(emcc, async (err, stdout, stderr) => {
-    if (err) {
+
+  for (const command of [packer, pack, ...builds]) {
+    try {
+      const {stdout, stderr} = await exec(command);
+
+      if (stdout) {
+        console.log(stdout);
+      }
+
+      if (stderr) {
+        console.log(stderr);
+      }
+    }
+    catch (err) {
       console.error(err.message);
       process.exit(1);
     }
+  }
 
-    if (stdout) {
-      console.log(stdout);
-    }
+  const intermediates = [
+    "pack_levels.js",
+    "pack_levels.wasm",
+    "embedded_level_data.cpp",
+  ];
 
-    if (stderr) {
-      console.log(stderr);
-    }
+  for (const f of intermediates) {
+    await fs.unlink(path.join(dist, f)).catch(err => {});
+  }
 
-    await cp(src, dist);
-  });
+  await cp(src, dist);
 })();
-
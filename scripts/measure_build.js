@@ -0,0 +1,132 @@
+const fs = require("fs").promises;
+const os = require("os");
+const path = require("path");
+const zlib = require("zlib");
+const {promisify} = require("util");
+const exec = promisify(require("child_process").exec);
+const puppeteer = require("puppeteer");
+const cp = require("./cp");
+const serve = require("./serve");
+
+// Builds the development and production profiles and compares what the
+// page downloads and how long it takes to make its first move.
+//
+//   node scripts/measure_build [--runs n] [--no-build]
+const i = process.argv.indexOf("--runs");
+const runs = i < 0 ? 5 : +process.argv[i + 1];
+const build = !process.argv.includes("--no-build");
+
+const port = 8002;
+const out = path.join(os.tmpdir(), "sokoban_profiles");
+const profiles = [
+  {name: "development", flags: ""},
+  {name: "production", flags: "--production"},
+];
+
+// What the page loads before the first move, for a browser with SIMD
+const files = ["sokoban_simd.js", "sokoban_simd.wasm", "levels.pack"];
+
+/**
+ * Cut a level pack down to the ranges the page fetches before the first
+ * move: the header and index, the first level's cells, which follow the
+ * index, and the metadata at the end
+ * @param Buffer pack the whole pack
+ * @return Buffer the bytes fetched
+*/
+const packFetched = pack => {
+  const count = pack.readUInt32LE(8);
+  const strings = pack.readUInt32LE(12);
+  const first = count ? pack.readUInt32LE(16) : strings;
+  const cells = count
+    ? Math.ceil(pack.readUInt16LE(20) * pack.readUInt16LE(22) / 2)
+    : 0;
+  return Buffer.concat([
+    pack.subarray(0, first + cells), pack.subarray(strings),
+  ]);
+};
+
+/**
+ * Measure the page's files
+ * @param string dir the built dist directory
+ * @return Promise<{bytes, gzip}> their total size, raw and gzipped
+*/
+const sizes = async dir => {
+  const total = {bytes: 0, gzip: 0};
+
+  for (const file of files) {
+    let body = await fs.readFile(path.join(dir, file)).catch(() => null);
+
+    if (body && file === "levels.pack") {
+      body = packFetched(body);
+    }
+
+    if (body) {
+      total.bytes += body.length;
+      total.gzip += zlib.gzipSync(body).length;
+    }
+  }
+
+  return total;
+};
+
+/**
+ * Time loading the test level with an empty cache until a key press has
+ * moved the player, which is when the undo button enables
+ * @param Browser browser the browser to load the page in
+ * @param string url the build's test level
+ * @return Promise<number> the median milliseconds over the runs
+*/
+const timeToFirstMove = async (browser, url) => {
+  const times = [];
+
+  for (let run = 0; run < runs; run++) {
+    const page = await browser.newPage();
+    await page.setCacheEnabled(false);
+    const start = Date.now();
+    await page.goto(url);
+    await page.waitForSelector("#game");
+    await page.keyboard.press("ArrowRight");
+    await page.waitForSelector("#undo:not([disabled])");
+    times.push(Date.now() - start);
+    await page.close();
+  }
+
+  return times.sort((a, b) => a - b)[Math.floor(times.length / 2)];
+};
+
+const kb = bytes => `${(bytes / 1024).toFixed(0)} KiB`.padStart(10);
+
+(async () => {
+  if (build) {
+    await fs.mkdir(out, {recursive: true});
+
+    for (const {name, flags} of profiles) {
+      try {
+        await exec(`node scripts/build ${flags}`);
+      }
+      catch (err) {
+        console.error(err.message);
+        process.exit(1);
+      }
+
+      await cp("dist", path.join(out, name));
+    }
+  }
+
+  const server = await serve(out, port);
+  const browser = await puppeteer.launch({headless: true});
+  console.log(`${"profile".padEnd(14)}${"size".padStart(10)}` +
+    `${"gzipped".padStart(10)}${"first move".padStart(14)}`);
+
+  for (const {name} of profiles) {
+    const {bytes, gzip} = await sizes(path.join(out, name));
+    const ms = await timeToFirstMove(
+      browser, `http://localhost:${port}/${name}/#101`
+    );
+    console.log(`${name.padEnd(14)}${kb(bytes)}${kb(gzip)}` +
+      `${`${ms} ms`.padStart(14)}`);
+  }
+
+  await browser.close();
+  server.close();
+})();
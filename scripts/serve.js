@@ -0,0 +1,90 @@
+const fs = require("fs").promises;
+const http = require("http");
+const path = require("path");
+
+// Shared memory, and so the threaded build, needs a cross-origin isolated
+// page. credentialless keeps the icon font loading without CORP headers.
+const headers = {
+  "Cross-Origin-Opener-Policy": "same-origin",
+  "Cross-Origin-Embedder-Policy": "credentialless",
+};
+
+const types = {
+  ".css": "text/css",
+  ".data": "application/octet-stream",
+  ".html": "text/html",
+  ".ico": "image/x-icon",
+  ".js": "text/javascript",
+  ".png": "image/png",
+  ".wasm": "application/wasm",
+};
+
+/**
+ * Serves a directory with the headers for cross-origin isolation
+ * @param string root the directory to serve
+ * @param number port the port to listen on
+ * @return Promise<http.Server> the server, once it's listening
+*/
+const serve = (root, port) => new Promise(resolve => {
+  const base = path.resolve(root);
+  const server = http.createServer(async (req, res) => {
+    const url = decodeURIComponent(new URL(req.url, "http://x").pathname);
+    let file = path.join(base, path.normalize(url));
+
+    if (!file.startsWith(base)) {
+      res.writeHead(403, headers).end();
+      return;
+    }
+
+    try {
+      if ((await fs.stat(file)).isDirectory()) {
+        if (!url.endsWith("/")) {
+          res.writeHead(301, {...headers, Location: `${url}/`}).end();
+          return;
+        }
+
+        file = path.join(file, "index.html");
+      }
+
+      const body = await fs.readFile(file);
+      const type = types[path.extname(file)] || "application/octet-stream";
+
+      // A single byte range, as the page reads the level pack in
+      const range = /^bytes=(\d+)-(\d*)$/.exec(req.headers.range || "");
+
+      if (range) {
+        const start = +range[1];
+        const end = Math.min(range[2] ? +range[2] : Infinity, body.length - 1);
+
+        if (start > end) {
+          res.writeHead(416, {
+            ...headers, "Content-Range": `bytes */${body.length}`,
+          }).end();
+          return;
+        }
+
+        res.writeHead(206, {
+          ...headers,
+          "Content-Type": type,
+          "Content-Range": `bytes ${start}-${end}/${body.length}`,
+        }).end(body.subarray(start, end + 1));
+        return;
+      }
+
+      res.writeHead(200, {...headers, "Content-Type": type}).end(body);
+    }
+    catch (err) {
+      res.writeHead(404, headers).end();
+    }
+  });
+  server.listen(port, () => resolve(server));
+});
+
+if (require.main === module) {
+  const port = +process.argv[2] || 8000;
+  serve(".", port).then(() =>
+    console.log(`Serving cross-origin isolated on http://localhost:${port}`)
+  );
+}
+
+module.exports = serve;
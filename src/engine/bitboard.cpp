@@ -0,0 +1,76 @@
+#include "bitboard.hpp"
+
+#include <algorithm>
+#include <utility>
+
+Bitboard::Bitboard(unsigned int cells, unsigned int width)
+    : width(width), margin(width / 64 + 1) {
+    words.assign((cells + 63) / 64 + 2 * margin, 0);
+}
+
+void Bitboard::set(unsigned int cell) {
+    words[margin + cell / 64] |= 1ull << (cell % 64);
+}
+
+void Bitboard::reset(unsigned int cell) {
+    words[margin + cell / 64] &= ~(1ull << (cell % 64));
+}
+
+bool Bitboard::test(unsigned int cell) const {
+    return words[margin + cell / 64] >> (cell % 64) & 1;
+}
+
+void Bitboard::subtract(const Bitboard &other) {
+    for (unsigned int i = 0; i < words.size(); i++) {
+        words[i] &= ~other.words[i];
+    }
+}
+
+Bitboard Bitboard::flood(unsigned int from) const {
+    Bitboard reached(*this);
+    Bitboard next(*this);
+    std::fill(reached.words.begin(), reached.words.end(), 0);
+    reached.set(from);
+
+    // A row is whole words plus bits; the double shifts stay defined when
+    // there are no extra bits
+    const unsigned int row = width / 64;
+    const unsigned int bits = width % 64;
+    const unsigned int end = words.size() - margin;
+    uint64_t changed = 1;
+
+    while (changed) {
+        const uint64_t *r = reached.words.data();
+        uint64_t *n = next.words.data();
+        changed = 0;
+
+        for (unsigned int i = margin; i < end; i++) {
+            const uint64_t left = r[i] << 1 | r[i - 1] >> 63;
+            const uint64_t right = r[i] >> 1 | r[i + 1] << 63;
+            const uint64_t down = r[i - row] << bits |
+                r[i - row - 1] >> (63 - bits) >> 1;
+            const uint64_t up = r[i + row] >> bits |
+                r[i + row + 1] << (63 - bits) << 1;
+            n[i] = (r[i] | left | right | down | up) & words[i];
+            changed |= n[i] ^ r[i];
+        }
+
+        std::swap(reached.words, next.words);
+    }
+
+    return reached;
+}
+
+unsigned int Bitboard::first() const {
+    unsigned int i = margin;
+
+    while (!words[i]) {
+        i++;
+    }
+
+    return (i - margin) * 64 + __builtin_ctzll(words[i]);
+}
+
+bool Bitboard::operator==(const Bitboard &other) const {
+    return words == other.words;
+}
@@ -0,0 +1,5 @@
+#include "embedded_levels.hpp"
+
+// The default build embeds no levels; see pack_levels --embed
+const EmbeddedLevels::Entry *const EmbeddedLevels::entries = nullptr;
+const unsigned int EmbeddedLevels::count = 0;
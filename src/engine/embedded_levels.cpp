@@ -0,0 +1,20 @@
+#include "embedded_levels.hpp"
+
+#include <string>
+
+std::vector<Level> EmbeddedLevels::levels() {
+    std::vector<Level> levels;
+    levels.reserve(count);
+
+    for (unsigned int i = 0; i < count; i++) {
+        const Entry &entry = entries[i];
+        levels.push_back({
+            {entry.rows, entry.rows + entry.height},
+            std::string(entry.author),
+            std::string(entry.title),
+            std::string(entry.comment),
+        });
+    }
+
+    return levels;
+}
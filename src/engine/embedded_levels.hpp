@@ -0,0 +1,67 @@
+#ifndef __EMBEDDED_LEVELS_H__
+#define __EMBEDDED_LEVELS_H__
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "level.hpp"
+
+/**
+ * Levels compiled into the binary, for builds that can't or shouldn't
+ * touch a filesystem. The data comes from embedded_level_data.cpp, which is
+ * empty by default; the embedded build swaps in one generated by
+ * pack_levels --embed, where every board is a constexpr array checked by
+ * static_assert with valid().
+*/
+class EmbeddedLevels {
+public:
+    /**
+     * A level as constant data
+    */
+    struct Entry {
+        const std::string_view *rows;
+        unsigned int height;
+        std::string_view title;
+        std::string_view author;
+        std::string_view comment;
+    };
+
+    /**
+     * The embedded levels, and how many there are
+    */
+    static const Entry *const entries;
+    static const unsigned int count;
+
+    /**
+     * Determine at compile time if a board uses only Sokoban symbols and
+     * has exactly one player. Constexpr, so it is defined here rather than
+     * in the source file.
+     * @param std::string_view board the board's rows
+     * @return bool true if the board can be played
+    */
+    template <std::size_t N>
+    static constexpr bool valid(const std::string_view (&board)[N]) {
+        const std::string_view symbols = "#@$*.+ ";
+        unsigned int players = 0;
+
+        for (const std::string_view row : board) {
+            for (const char cell : row) {
+                if (symbols.find(cell) == std::string_view::npos) {
+                    return false;
+                }
+
+                players += cell == '@' || cell == '+';
+            }
+        }
+
+        return players == 1;
+    }
+
+    /**
+     * Copy the embedded levels into Levels for a LevelStore
+     * @return std::vector<Level> the levels in order
+    */
+    static std::vector<Level> levels();
+};
+#endif
@@ -0,0 +1,299 @@
+#include "external_solver.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <stdexcept>
+
+#include "run_file.hpp"
+
+ExternalSolver::ExternalSolver(const std::vector<std::string> &board)
+    : maze(board), width(2 + 2 * maze.initial().boxes.size()) {
+    if (width > 256) {
+        throw std::invalid_argument("Too many boxes for an external search");
+    }
+}
+
+ExternalSolver::~ExternalSolver() {
+    std::error_code error;
+
+    if (!workspace.empty()) {
+        std::filesystem::remove_all(workspace, error);
+    }
+}
+
+std::string ExternalSolver::path(const std::string &name) const {
+    return (std::filesystem::path(workspace) / name).string();
+}
+
+void ExternalSolver::encode(
+    const Maze::State &state,
+    unsigned char *record
+) const {
+    record[0] = state.player >> 8;
+    record[1] = state.player & 0xff;
+
+    for (unsigned int i = 0; i < state.boxes.size(); i++) {
+        record[2 + 2 * i] = state.boxes[i] >> 8;
+        record[3 + 2 * i] = state.boxes[i] & 0xff;
+    }
+}
+
+Maze::State ExternalSolver::decode(const unsigned char *record) const {
+    Maze::State state{
+        (unsigned short) (record[0] << 8 | record[1]),
+        std::vector<unsigned short>(width / 2 - 1)
+    };
+
+    for (unsigned int i = 0; i < state.boxes.size(); i++) {
+        state.boxes[i] = record[2 + 2 * i] << 8 | record[3 + 2 * i];
+    }
+
+    return state;
+}
+
+void ExternalSolver::spill(
+    std::vector<unsigned char> &buffer,
+    const std::string &name
+) const {
+    const unsigned char *records = buffer.data();
+    std::vector<unsigned int> order(buffer.size() / width);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::memcmp(records + a * width, records + b * width,
+            width) < 0;
+    });
+
+    RunFile::Writer run(path(name), width);
+    const unsigned char *previous = nullptr;
+
+    for (const unsigned int i : order) {
+        const unsigned char *record = records + (size_t) i * width;
+
+        if (!previous || std::memcmp(previous, record, width) != 0) {
+            run.write(record);
+            previous = record;
+        }
+    }
+
+    run.close();
+    buffer.clear();
+}
+
+unsigned long ExternalSolver::merge(
+    const std::vector<std::string> &runs,
+    unsigned int depth
+) const {
+    std::vector<RunFile::Reader> readers;
+
+    for (const std::string &run : runs) {
+        readers.emplace_back(path(run), width);
+    }
+
+    const auto later = [&](unsigned int a, unsigned int b) {
+        return readers[a].record() > readers[b].record();
+    };
+    std::priority_queue<unsigned int, std::vector<unsigned int>,
+        decltype(later)> heads(later);
+
+    for (unsigned int i = 0; i < readers.size(); i++) {
+        if (readers[i].next()) {
+            heads.push(i);
+        }
+    }
+
+    RunFile::Reader closed(path("closed.run"), width);
+    RunFile::Writer layer(path("layer-" + std::to_string(depth) + ".run"),
+        width);
+    RunFile::Writer grown(path("closed-next.run"), width);
+    bool more_closed = closed.next();
+
+    // The last record merged, kept at its first size so that each new
+    // record is copied into it without allocating
+    std::vector<unsigned char> last;
+
+    while (!heads.empty()) {
+        const unsigned int head = heads.top();
+        heads.pop();
+
+        // Compared in the reader's own buffer, which next() overwrites, so
+        // the reader only moves on once the record has been handled
+        const std::vector<unsigned char> &record = readers[head].record();
+
+        if (record != last) {
+            last.assign(record.begin(), record.end());
+
+            for (; more_closed && closed.record() < record;
+                 more_closed = closed.next()) {
+                grown.write(closed.record().data());
+            }
+
+            // States seen in an earlier layer are copied over by the loop
+            // above once the merge moves past them
+            if (!more_closed || closed.record() != record) {
+                layer.write(record.data());
+                grown.write(record.data());
+            }
+        }
+
+        if (readers[head].next()) {
+            heads.push(head);
+        }
+    }
+
+    for (; more_closed; more_closed = closed.next()) {
+        grown.write(closed.record().data());
+    }
+
+    layer.close();
+    grown.close();
+    closed.close();
+    std::filesystem::rename(path("closed-next.run"), path("closed.run"));
+
+    return layer.count();
+}
+
+std::string ExternalSolver::trace(Maze::State goal, unsigned int depth) const {
+    std::vector<Maze::Push> line;
+
+    for (; depth > 0; depth--) {
+        RunFile::Reader layer(
+            path("layer-" + std::to_string(depth - 1) + ".run"), width);
+        bool found = false;
+
+        while (!found && layer.next()) {
+            const Maze::State state = decode(layer.record().data());
+
+            for (const Maze::Successor &successor : maze.successors(state)) {
+                if (!found && successor.state == goal) {
+                    line.push_back(successor.push);
+                    goal = state;
+                    found = true;
+                }
+            }
+        }
+
+        if (!found) {
+            throw std::invalid_argument("Broken layer files in " + workspace);
+        }
+    }
+
+    std::reverse(line.begin(), line.end());
+    return maze.moves(maze.start(), maze.initial().boxes, line);
+}
+
+Solver::Result ExternalSolver::solve(const Options &options) {
+    namespace fs = std::filesystem;
+    using clock = std::chrono::steady_clock;
+    const auto deadline = clock::now() + options.time_limit;
+    const fs::path base = options.directory.empty() ?
+        fs::temp_directory_path() : fs::path(options.directory);
+
+    if (!workspace.empty()) {
+        fs::remove_all(workspace);
+    }
+
+    // create_directory() is atomic and fails on a name that's taken, so
+    // searches in other threads or processes never share a workspace
+    fs::create_directories(base);
+    std::random_device random;
+    workspace.clear();
+
+    for (unsigned int attempt = 0; workspace.empty(); attempt++) {
+        if (attempt == 100) {
+            throw std::invalid_argument(
+                "Cannot create a workspace in " + base.string()
+            );
+        }
+
+        const fs::path candidate = base / ("sokoban-" +
+            std::to_string(random()) + "-" + std::to_string(random()));
+
+        if (fs::create_directory(candidate)) {
+            workspace = candidate.string();
+        }
+    }
+
+    const Maze::State root = maze.initial();
+    unsigned long expanded = 0;
+
+    if (maze.solved(root)) {
+        return {Solver::SOLVED, "", true, 0, 0, 0};
+    }
+
+    std::vector<unsigned char> buffer(width);
+    encode(root, buffer.data());
+    spill(buffer, "layer-0.run");
+    fs::copy_file(path("layer-0.run"), path("closed.run"));
+
+    for (unsigned int depth = 0;; depth++) {
+        const auto stop = [&](Solver::Status status) {
+            if (options.progress) {
+                options.progress({expanded, depth, depth + 1});
+            }
+            return Solver::Result{status, "", false, 0, expanded, depth + 1};
+        };
+
+        RunFile::Reader layer(
+            path("layer-" + std::to_string(depth) + ".run"), width);
+        std::vector<std::string> runs;
+
+        while (layer.next()) {
+            if (options.cancelled &&
+                options.cancelled->load(std::memory_order_relaxed)) {
+                return stop(Solver::CANCELLED);
+            }
+
+            const bool out_of_nodes = options.node_limit &&
+                expanded >= options.node_limit;
+            const bool out_of_time = options.time_limit.count() &&
+                expanded % 64 == 0 && clock::now() >= deadline;
+
+            if (out_of_nodes || out_of_time) {
+                return stop(Solver::BUDGET_EXHAUSTED);
+            }
+
+            const Maze::State state = decode(layer.record().data());
+
+            for (const Maze::Successor &successor : maze.successors(state)) {
+                if (maze.solved(successor.state)) {
+                    Solver::Result result = stop(Solver::SOLVED);
+                    result.solution = trace(successor.state, depth + 1);
+                    result.optimal = true;
+                    result.pushes = depth + 1;
+                    return result;
+                }
+
+                buffer.resize(buffer.size() + width);
+                encode(successor.state, &buffer[buffer.size() - width]);
+            }
+
+            if (buffer.size() >= options.memory_limit) {
+                runs.push_back("spill-" + std::to_string(runs.size()));
+                spill(buffer, runs.back());
+            }
+
+            expanded++;
+
+            if (options.progress && options.progress_interval &&
+                expanded % options.progress_interval == 0) {
+                options.progress({expanded, depth, depth + 1});
+            }
+        }
+
+        runs.push_back("spill-" + std::to_string(runs.size()));
+        spill(buffer, runs.back());
+        const unsigned long size = merge(runs, depth + 1);
+
+        for (const std::string &run : runs) {
+            fs::remove(path(run));
+        }
+
+        if (size == 0) {
+            return stop(Solver::UNSOLVABLE);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef __EXTERNAL_SOLVER_H__
+#define __EXTERNAL_SOLVER_H__
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "maze.hpp"
+#include "solver.hpp"
+
+/**
+ * A push-optimal breadth-first solver for levels whose state space does not
+ * fit in memory. Each layer of the search lives on disk as a sorted,
+ * front-coded run; successors are buffered up to a memory limit, sorted and
+ * spilled as runs, and duplicates are removed by merging those runs against
+ * each other and against the closed set of every earlier layer.
+ *
+ * Layers are kept until the search ends so the solution can be rebuilt by
+ * walking back through them.
+*/
+class ExternalSolver {
+public:
+    /**
+     * Limits and hooks for a call to solve(); zero limits are unlimited
+    */
+    struct Options {
+        std::chrono::milliseconds time_limit{0};
+        unsigned long node_limit = 0;
+
+        std::function<void(const Solver::Progress &)> progress;
+        unsigned long progress_interval = 100000;
+        const std::atomic<bool> *cancelled = nullptr;
+
+        /**
+         * Bytes of successors buffered in memory before a run is spilled
+        */
+        unsigned long memory_limit = 256ul << 20;
+
+        /**
+         * Directory for run files; empty uses the system temporary directory
+        */
+        std::string directory;
+    };
+
+private:
+    Maze maze;
+
+    /**
+     * Size of an encoded state: the player then every box, as big-endian
+     * 16-bit cells so that byte order matches state order
+    */
+    unsigned int width;
+
+    /**
+     * The directory holding this search's files, removed on destruction
+    */
+    std::string workspace;
+
+    /**
+     * Return the path of a file in the workspace
+     * @param std::string name the file name
+     * @return std::string the full path
+    */
+    std::string path(const std::string &name) const;
+
+    /**
+     * Encode a state into width bytes at record
+    */
+    void encode(const Maze::State &state, unsigned char *record) const;
+
+    /**
+     * Decode width bytes back into a state
+    */
+    Maze::State decode(const unsigned char *record) const;
+
+    /**
+     * Sort and deduplicate buffered records and write them as a run
+     * @param std::vector<unsigned char> buffer the records, emptied after
+     * @param std::string name the run file to write
+    */
+    void spill(std::vector<unsigned char> &buffer,
+        const std::string &name) const;
+
+    /**
+     * Merge runs into the next layer, dropping duplicates and every state
+     * already in the closed set, and write the grown closed set alongside
+     * @param std::vector<std::string> runs the run files to merge
+     * @param unsigned int depth the depth of the new layer
+     * @return unsigned long the number of states in the new layer
+    */
+    unsigned long merge(const std::vector<std::string> &runs,
+        unsigned int depth) const;
+
+    /**
+     * Walk back from a solved state through the stored layers
+     * @param Maze::State goal the solved state
+     * @param unsigned int depth the layer it was found in
+     * @return std::string the LURD solution
+    */
+    std::string trace(Maze::State goal, unsigned int depth) const;
+
+public:
+    /**
+     * Constructor which accepts a board in the same format Sokoban uses
+     * @param std::vector<std::string> board the level to solve
+    */
+    ExternalSolver(const std::vector<std::string> &board);
+
+    /**
+     * Removes the search's files
+    */
+    ~ExternalSolver();
+
+    ExternalSolver(const ExternalSolver &) = delete;
+    ExternalSolver &operator=(const ExternalSolver &) = delete;
+
+    /**
+     * Search layer by layer until the level is solved optimally, proven
+     * unsolvable, a budget runs out or the search is cancelled
+     * @param Options options the budgets, hooks and memory limit
+     * @return Solver::Result the result; early stops carry no solution
+    */
+    Solver::Result solve(const Options &options);
+};
+#endif
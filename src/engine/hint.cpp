@@ -0,0 +1,97 @@
+#include "hint.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <unordered_set>
+
+#include "solver.hpp"
+
+Hint::Hint(const std::vector<std::string> &level, const Options &options)
+    : maze(level), options(options) {
+}
+
+Hint::Hint(const std::vector<std::string> &level) : Hint(level, Options()) {
+}
+
+void Hint::cache(const Maze::State &start, const std::string &solution) {
+    Maze::State position = start;
+    line = solution;
+    positions.clear();
+    positions[position] = 0;
+
+    for (unsigned int i = 0; i < line.size(); i++) {
+        const char move = std::toupper(line[i]);
+        maze.step(position, std::strchr(Maze::pushes, move) - Maze::pushes);
+        positions[position] = i + 1;
+    }
+}
+
+bool Hint::reconnect(const Maze::State &start) {
+    struct Visit {
+        Maze::State position;
+        unsigned int parent;
+        char move;
+    };
+
+    std::vector<Visit> visits = {{start, 0, 0}};
+    std::unordered_set<Maze::State, Maze::StateHash> seen = {start};
+
+    for (unsigned int v = 0;
+         v < visits.size() && visits.size() < options.reconnect_limit; v++) {
+        const auto found = positions.find(visits[v].position);
+
+        if (found != positions.end()) {
+            std::string path;
+
+            for (unsigned int u = v; u != 0; u = visits[u].parent) {
+                path.push_back(visits[u].move);
+            }
+
+            cache(start, std::string(path.rbegin(), path.rend()) +
+                line.substr(found->second));
+            return true;
+        }
+
+        for (unsigned int direction = 0; direction < 4; direction++) {
+            Maze::State next = visits[v].position;
+            const char move = maze.step(next, direction);
+
+            if (move && seen.insert(next).second) {
+                visits.push_back({std::move(next), v, move});
+            }
+        }
+    }
+
+    return false;
+}
+
+char Hint::next(const std::vector<std::string> &board) {
+    const Maze::State position = maze.position(board);
+
+    if (maze.solved(position)) {
+        return 0;
+    }
+
+    const auto found = positions.find(position);
+
+    if (found != positions.end()) {
+        return line[found->second];
+    }
+
+    if (!positions.empty() && reconnect(position)) {
+        return line[0];
+    }
+
+    Solver::Options solve;
+    solve.time_limit = options.solve_limit;
+    solve.weight = options.weight;
+    solve.first = true;
+    const Solver::Result result = Solver(board).solve(solve);
+
+    if (result.status != Solver::SOLVED) {
+        return 0;
+    }
+
+    cache(position, result.solution);
+    return line[0];
+}
@@ -0,0 +1,90 @@
+#ifndef __HINT_H__
+#define __HINT_H__
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "maze.hpp"
+
+/**
+ * Suggests the next move for a game in progress. A solution is cached with
+ * every position along it, so hints while the player follows it are a
+ * lookup. When the player strays, a short search reconnects to the nearest
+ * position on the cached line, and only when that fails is the level solved
+ * again from the current position.
+*/
+class Hint {
+public:
+    /**
+     * Limits on the work done for a single hint
+    */
+    struct Options {
+        /**
+         * Most positions visited while reconnecting to the cached line
+        */
+        unsigned long reconnect_limit = 50000;
+
+        /**
+         * Time allowed for solving from scratch; the first solution found
+         * is used, optimal or not
+        */
+        std::chrono::milliseconds solve_limit{5000};
+
+        /**
+         * Heuristic weight for solving from scratch; greedier searches
+         * find a first solution on far more levels within the limit
+        */
+        unsigned int weight = 3;
+    };
+
+private:
+    Maze maze;
+    Options options;
+
+    /**
+     * The cached LURD solution and the index of the last time it passes
+     * through each exact position
+    */
+    std::string line;
+    std::unordered_map<Maze::State, unsigned int, Maze::StateHash> positions;
+
+    /**
+     * Replace the cached line with one starting at a position
+     * @param Maze::State start the exact position the line starts from
+     * @param std::string solution the new line
+    */
+    void cache(const Maze::State &start, const std::string &solution);
+
+    /**
+     * Search outward from a position for one on the cached line and splice
+     * the way there onto the rest of the line
+     * @param Maze::State start the exact position to search from
+     * @return bool true if the line now starts at start, false otherwise
+    */
+    bool reconnect(const Maze::State &start);
+
+public:
+    /**
+     * Constructor which accepts the level hints are given for
+     * @param std::vector<std::string> level the level's starting board
+     * @param Options options the limits on each hint
+    */
+    Hint(const std::vector<std::string> &level, const Options &options);
+
+    /**
+     * Constructor with the default limits
+     * @param std::vector<std::string> level the level's starting board
+    */
+    Hint(const std::vector<std::string> &level);
+
+    /**
+     * Return the next move towards a solution
+     * @param std::vector<std::string> board the current board of the level
+     * @return char the LURD move (uppercase for a push), or 0 when the
+     * board is solved or no solution was found
+    */
+    char next(const std::vector<std::string> &board);
+};
+#endif
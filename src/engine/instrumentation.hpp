@@ -0,0 +1,15 @@
+#ifndef __INSTRUMENTATION_H__
+#define __INSTRUMENTATION_H__
+
+/**
+ * Whether the engine and the solver keep counters on their hot paths, set
+ * by compiling with -DSOKOBAN_STATS. Every counter is updated inside an
+ * if constexpr on this, so without the flag no counting code is compiled
+ * and the stats() calls return zeros.
+*/
+#ifdef SOKOBAN_STATS
+constexpr bool instrumented = true;
+#else
+constexpr bool instrumented = false;
+#endif
+#endif
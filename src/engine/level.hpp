@@ -0,0 +1,16 @@
+#ifndef __LEVEL_H__
+#define __LEVEL_H__
+
+#include <string>
+#include <vector>
+
+/**
+ * A level's board together with the metadata its file carries
+*/
+struct Level {
+    std::vector<std::string> board;
+    std::string author;
+    std::string title;
+    std::string comment;
+};
+#endif
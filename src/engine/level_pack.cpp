@@ -0,0 +1,268 @@
+#include "level_pack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+// Constant-initialized so packs can be built during static initialization
+constexpr std::string_view pack_magic = "SOKP";
+const char *const cell_codes = " #@$*.+";
+const size_t header_size = 16;
+const size_t entry_size = 24;
+
+/**
+ * Append the low bytes of a value in little-endian order
+*/
+void put(std::string &out, unsigned long long value, unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; i++) {
+        out.push_back((char) (value >> (8 * i)));
+    }
+}
+
+/**
+ * Overwrite bytes already appended with a little-endian value
+*/
+void patch(std::string &out, size_t offset, unsigned long long value,
+           unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; i++) {
+        out[offset + i] = (char) (value >> (8 * i));
+    }
+}
+
+}
+
+std::string LevelPack::encode(const std::vector<Level> &levels) {
+    std::string out(pack_magic);
+    put(out, version, 4);
+    put(out, levels.size(), 4);
+    put(out, 0, 4);
+    out.resize(header_size + entry_size * levels.size());
+    std::string strings;
+    std::unordered_map<std::string, size_t> interned;
+
+    // Metadata repeats across a collection, so each string is stored once
+    const auto intern = [&](const std::string &text) {
+        const auto [found, added] = interned.emplace(text, strings.size());
+
+        if (added) {
+            strings.append(text.c_str(), text.size() + 1);
+        }
+
+        return found->second;
+    };
+
+    for (size_t i = 0; i < levels.size(); i++) {
+        const std::vector<std::string> &board = levels[i].board;
+        size_t columns = 0;
+        unsigned int boxes = 0;
+
+        for (const std::string &row : board) {
+            columns = std::max(columns, row.size());
+            boxes += std::count(row.begin(), row.end(), '$') +
+                std::count(row.begin(), row.end(), '*');
+        }
+
+        if (board.size() > 0xffff || columns > 0xffff) {
+            throw std::invalid_argument("Level too large to pack");
+        }
+
+        const size_t entry = header_size + entry_size * i;
+        patch(out, entry, out.size(), 4);
+        patch(out, entry + 4, board.size(), 2);
+        patch(out, entry + 6, columns, 2);
+        patch(out, entry + 8, boxes, 2);
+        patch(out, entry + 10, 0, 2);
+        patch(out, entry + 12, intern(levels[i].title), 4);
+        patch(out, entry + 16, intern(levels[i].author), 4);
+        patch(out, entry + 20, intern(levels[i].comment), 4);
+        std::string cells((board.size() * columns + 1) / 2, '\0');
+
+        for (size_t y = 0; y < board.size(); y++) {
+            for (size_t x = 0; x < board[y].size(); x++) {
+                const char *code = std::strchr(cell_codes, board[y][x]);
+
+                if (board[y][x] == '\0' || !code) {
+                    throw std::invalid_argument(
+                        "Cannot pack cell '" + std::string(1, board[y][x]) +
+                        "'"
+                    );
+                }
+
+                const size_t cell = y * columns + x;
+                cells[cell / 2] |= (char) ((code - cell_codes + 1) <<
+                    (cell % 2 * 4));
+            }
+        }
+
+        out += cells;
+    }
+
+    patch(out, 12, out.size(), 4);
+    return out + strings;
+}
+
+LevelPack LevelPack::load(const std::string &path, bool filled) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+
+    if (!in) {
+        throw std::invalid_argument("Cannot open file " + path);
+    }
+
+    std::string data(in.tellg(), '\0');
+    in.seekg(0);
+    in.read(data.data(), data.size());
+
+    if (!in) {
+        throw std::invalid_argument("Cannot read file " + path);
+    }
+
+    return LevelPack(std::move(data), filled);
+}
+
+LevelPack::LevelPack() : LevelPack(encode({})) {
+}
+
+LevelPack::LevelPack(std::string data, bool filled)
+    : data(std::move(data)) {
+    if (this->data.size() < header_size ||
+        this->data.compare(0, 4, pack_magic) ||
+        read(4, 4) != version) {
+        throw std::invalid_argument("Not a level pack of version " +
+            std::to_string(version));
+    }
+
+    count = read(8, 4);
+    strings = read(12, 4);
+
+    if (strings > this->data.size() ||
+        (strings < this->data.size() && this->data.back() != '\0') ||
+        count > (strings - header_size) / entry_size) {
+        throw std::invalid_argument("Corrupt level pack");
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        const size_t at = header_size + entry_size * i;
+        const size_t cells = (size_t) read(at + 4, 2) * read(at + 6, 2);
+
+        if (read(at, 4) + (cells + 1) / 2 > strings ||
+            read(at + 12, 4) >= this->data.size() - strings ||
+            read(at + 16, 4) >= this->data.size() - strings ||
+            read(at + 20, 4) >= this->data.size() - strings) {
+            throw std::invalid_argument("Corrupt level pack");
+        }
+    }
+
+    present.assign(count, filled);
+}
+
+unsigned int LevelPack::read(size_t offset, unsigned int bytes) const {
+    unsigned int value = 0;
+
+    for (unsigned int i = 0; i < bytes; i++) {
+        value |= (unsigned int) (unsigned char) data[offset + i] << (8 * i);
+    }
+
+    return value;
+}
+
+size_t LevelPack::entry(unsigned int level) const {
+    if (level >= count) {
+        throw std::invalid_argument(
+            "Level " + std::to_string(level) + " is not in the pack"
+        );
+    }
+
+    return header_size + entry_size * level;
+}
+
+unsigned int LevelPack::size() const {
+    return count;
+}
+
+unsigned int LevelPack::rows(unsigned int level) const {
+    return read(entry(level) + 4, 2);
+}
+
+unsigned int LevelPack::columns(unsigned int level) const {
+    return read(entry(level) + 6, 2);
+}
+
+unsigned int LevelPack::boxes(unsigned int level) const {
+    return read(entry(level) + 8, 2);
+}
+
+const char *LevelPack::title(unsigned int level) const {
+    return data.c_str() + strings + read(entry(level) + 12, 4);
+}
+
+const char *LevelPack::author(unsigned int level) const {
+    return data.c_str() + strings + read(entry(level) + 16, 4);
+}
+
+const char *LevelPack::comment(unsigned int level) const {
+    return data.c_str() + strings + read(entry(level) + 20, 4);
+}
+
+void LevelPack::fill(unsigned int level, std::string_view cells) {
+    const size_t at = entry(level);
+    const size_t size = (size_t) read(at + 4, 2) * read(at + 6, 2);
+
+    if (cells.size() != (size + 1) / 2) {
+        throw std::invalid_argument(
+            "Cells don't fit level " + std::to_string(level)
+        );
+    }
+
+    data.replace(read(at, 4), cells.size(), cells);
+    present[level] = true;
+}
+
+bool LevelPack::filled(unsigned int level) const {
+    // entry() throws for a level that isn't in the pack
+    entry(level);
+    return present[level];
+}
+
+std::vector<std::string> LevelPack::board(unsigned int level) const {
+    const size_t at = entry(level);
+
+    if (!present[level]) {
+        throw std::invalid_argument(
+            "Level " + std::to_string(level) + " has not been filled in"
+        );
+    }
+
+    const size_t cells = read(at, 4);
+    const unsigned int columns = read(at + 6, 2);
+    std::vector<std::string> board(read(at + 4, 2));
+
+    for (size_t y = 0; y < board.size(); y++) {
+        board[y].reserve(columns);
+
+        for (size_t x = 0; x < columns; x++) {
+            const size_t cell = y * columns + x;
+            const unsigned int code =
+                (unsigned char) data[cells + cell / 2] >> (cell % 2 * 4) & 0xf;
+
+            if (code == 0) {
+                break;
+            }
+            else if (code > std::strlen(cell_codes)) {
+                throw std::invalid_argument("Corrupt level pack");
+            }
+
+            board[y].push_back(cell_codes[code - 1]);
+        }
+    }
+
+    return board;
+}
+
+Level LevelPack::level(unsigned int level) const {
+    return {board(level), author(level), title(level), comment(level)};
+}
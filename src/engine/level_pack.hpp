@@ -0,0 +1,159 @@
+#ifndef __LEVEL_PACK_H__
+#define __LEVEL_PACK_H__
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "level.hpp"
+
+/**
+ * A read-only collection of levels in a compact binary format, built ahead
+ * of time so loading is a single read with no parsing. Levels are decoded
+ * only when asked for; their sizes, box counts and metadata come straight
+ * from the index.
+ *
+ * Layout, all integers little-endian:
+ *   header  "SOKP", version (4 bytes), level count (4), string table
+ *           offset (4)
+ *   index   per level: cells offset (4), rows (2), columns (2), boxes (2),
+ *           reserved (2), title, author and comment offsets into the
+ *           string table (4 each)
+ *   cells   per level: rows * columns 4-bit codes, two to a byte, low
+ *           nibble first; 0 pads short rows and 1-7 are " #@$*.+"
+ *   strings NUL-terminated metadata
+*/
+class LevelPack {
+    std::string data;
+    unsigned int count;
+    unsigned int strings;
+
+    /**
+     * Whether each level's cells are in the buffer, false for levels still
+     * to be fill()ed in
+    */
+    std::vector<bool> present;
+
+    /**
+     * Read a little-endian value from the buffer
+     * @param size_t offset where the value starts
+     * @param unsigned int bytes the width of the value
+     * @return unsigned int the value
+    */
+    unsigned int read(size_t offset, unsigned int bytes) const;
+
+    /**
+     * Find a level's entry in the index, checking the level exists
+     * @param unsigned int level the level number
+     * @return size_t the offset of the entry
+    */
+    size_t entry(unsigned int level) const;
+
+public:
+    /**
+     * The version of the format written by encode()
+    */
+    static const unsigned int version = 1;
+
+    /**
+     * Build a pack from levels
+     * @param std::vector<Level> levels the levels in order
+     * @return std::string the pack's bytes
+    */
+    static std::string encode(const std::vector<Level> &levels);
+
+    /**
+     * Read a pack from a file with a single read
+     * @param std::string path the pack file
+     * @param bool filled false if the file's cells are zeros still to be
+     * fill()ed in
+     * @return LevelPack the pack
+    */
+    static LevelPack load(const std::string &path, bool filled = true);
+
+    /**
+     * Constructor for an empty pack
+    */
+    LevelPack();
+
+    /**
+     * Constructor which takes ownership of a pack's bytes, checking that
+     * its header and index are sound
+     * @param std::string data the bytes written by encode()
+     * @param bool filled false if the cells are zeros still to be fill()ed
+     * in, so that no level decodes until its cells arrive
+    */
+    LevelPack(std::string data, bool filled = true);
+
+    /**
+     * @return unsigned int the number of levels
+    */
+    unsigned int size() const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return unsigned int the number of rows in the level's board
+    */
+    unsigned int rows(unsigned int level) const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return unsigned int the length of the board's longest row
+    */
+    unsigned int columns(unsigned int level) const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return unsigned int the number of boxes on the board
+    */
+    unsigned int boxes(unsigned int level) const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return const char * the level's title, or "" if there is none
+    */
+    const char *title(unsigned int level) const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return const char * the level's author, or "" if there is none
+    */
+    const char *author(unsigned int level) const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return const char * the level's comment, or "" if there is none
+    */
+    const char *comment(unsigned int level) const;
+
+    /**
+     * Copy in a level's cells, for a pack whose header, index and strings
+     * were read first with its cells left as zeros, as the page does to
+     * fetch each level only when it's played
+     * @param unsigned int level the level number
+     * @param std::string_view cells the level's bytes of the cells section
+    */
+    void fill(unsigned int level, std::string_view cells);
+
+    /**
+     * @param unsigned int level the level number
+     * @return bool true once the level's cells are in the pack
+    */
+    bool filled(unsigned int level) const;
+
+    /**
+     * Decode a level's board, refusing a level whose cells haven't been
+     * filled in
+     * @param unsigned int level the level number
+     * @return std::vector<std::string> the board as it was packed
+    */
+    std::vector<std::string> board(unsigned int level) const;
+
+    /**
+     * Decode a level's board and metadata
+     * @param unsigned int level the level number
+     * @return Level the level as it was packed
+    */
+    Level level(unsigned int level) const;
+};
+#endif
@@ -0,0 +1,299 @@
+#include "level_parser.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+std::string_view LevelParser::next_line(std::string_view text, size_t &begin) {
+    size_t end = text.find('\n', begin);
+
+    if (end == std::string_view::npos) {
+        end = text.size();
+    }
+
+    std::string_view line = text.substr(begin, end - begin);
+    begin = end + 1;
+
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    return line;
+}
+
+bool LevelParser::board_row(std::string_view line) {
+    return line.find_first_not_of("#@$*.+ ") == std::string_view::npos &&
+        line.find('#') != std::string_view::npos;
+}
+
+std::string_view LevelParser::trim(std::string_view text) {
+    const size_t begin = text.find_first_not_of(" \t");
+
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+
+    return text.substr(begin, text.find_last_not_of(" \t") - begin + 1);
+}
+
+bool LevelParser::key_equals(std::string_view key, std::string_view name) {
+    if (key.size() != name.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < key.size(); i++) {
+        if (std::tolower((unsigned char) key[i]) != name[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void LevelParser::metadata(
+    std::string_view line,
+    Level &level,
+    bool &in_comment
+) {
+    const size_t colon = line.find(':');
+    const std::string_view key =
+        colon == std::string_view::npos ? "" : trim(line.substr(0, colon));
+
+    if (in_comment) {
+        if (key_equals(key, "comment-end") || key_equals(key, "comment_end")) {
+            in_comment = false;
+        }
+        else {
+            if (!level.comment.empty()) {
+                level.comment.push_back('\n');
+            }
+
+            level.comment.append(line);
+        }
+
+        return;
+    }
+
+    if (colon == std::string_view::npos) {
+        return;
+    }
+
+    const std::string_view value = trim(line.substr(colon + 1));
+
+    if (key_equals(key, "author")) {
+        level.author = value;
+    }
+    else if (key_equals(key, "title")) {
+        level.title = value;
+    }
+    else if (key_equals(key, "comment")) {
+        level.comment = value;
+        in_comment = value.empty();
+    }
+}
+
+Level LevelParser::parse(std::string_view text) {
+    Level level;
+    bool board_done = false;
+    bool in_comment = false;
+
+    for (size_t begin = 0; begin < text.size();) {
+        const std::string_view line = next_line(text, begin);
+
+        if (!board_done) {
+            if (board_row(line)) {
+                level.board.emplace_back(line);
+                continue;
+            }
+            else if (level.board.empty()) {
+                continue;
+            }
+
+            // The first line that isn't part of the board ends it
+            board_done = true;
+        }
+
+        metadata(line, level, in_comment);
+    }
+
+    return level;
+}
+
+std::vector<std::string_view> LevelParser::split(
+    std::string_view text,
+    std::string_view &header
+) {
+    std::vector<std::string_view> levels;
+    size_t start = std::string_view::npos;
+    bool in_board = false;
+    bool in_comment = false;
+    Level ignored;
+    header = text;
+
+    for (size_t begin = 0; begin < text.size();) {
+        const size_t offset = begin;
+        const std::string_view line = next_line(text, begin);
+
+        if (!in_comment && board_row(line)) {
+            if (!in_board) {
+                if (start == std::string_view::npos) {
+                    header = text.substr(0, offset);
+                }
+                else {
+                    levels.push_back(text.substr(start, offset - start));
+                }
+
+                start = offset;
+                in_board = true;
+            }
+
+            continue;
+        }
+
+        in_board = false;
+
+        // Only comment blocks need tracking so boards in them are skipped
+        metadata(line, ignored, in_comment);
+        ignored.comment.clear();
+    }
+
+    if (start != std::string_view::npos) {
+        levels.push_back(text.substr(start));
+    }
+
+    return levels;
+}
+
+std::vector<Level> LevelParser::parse_collection(
+    std::string_view text,
+    unsigned int threads
+) {
+    std::string_view header_text;
+    const std::vector<std::string_view> texts = split(text, header_text);
+    Level header;
+    bool in_comment = false;
+
+    for (size_t begin = 0; begin < header_text.size();) {
+        metadata(next_line(header_text, begin), header, in_comment);
+    }
+
+    std::vector<Level> levels(texts.size());
+    std::atomic<size_t> next(0);
+    const auto work = [&]() {
+        for (size_t i = next++; i < texts.size(); i = next++) {
+            levels[i] = parse(texts[i]);
+
+            if (levels[i].author.empty()) {
+                levels[i].author = header.author;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 1; i < threads && i < texts.size(); i++) {
+        try {
+            workers.emplace_back(work);
+        }
+        catch (const std::system_error &) {
+            // Builds without thread support parse on this thread alone
+            break;
+        }
+    }
+
+    work();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    return levels;
+}
+
+std::vector<Level> LevelParser::read_directory(
+    const std::string &path,
+    unsigned int threads
+) {
+    std::map<unsigned int, Level> ordered_levels;
+    std::map<std::string, std::vector<Level>> collections;
+    std::string text;
+
+    for (const auto& entry : std::filesystem::directory_iterator(path)) {
+        std::ifstream level_file(entry.path(), std::ios::binary);
+        const std::string file = entry.path().u8string();
+        const std::string extension = entry.path().extension().u8string();
+
+        if (!level_file) {
+            throw std::invalid_argument("Cannot open file " + file);
+        }
+
+        text.resize(entry.file_size());
+        level_file.read(text.data(), text.size());
+        text.resize(level_file.gcount());
+
+        if (extension == ".sok" || extension == ".txt") {
+            collections[file] = parse_collection(text, threads);
+            continue;
+        }
+
+        Level level = parse(text);
+
+        if (level.board.size() > 2) {
+            ordered_levels[number(file)] = std::move(level);
+        }
+    }
+
+    std::vector<Level> levels;
+
+    for (auto &[_, level] : ordered_levels) {
+        levels.push_back(std::move(level));
+    }
+
+    for (auto &[_, collection] : collections) {
+        for (Level &level : collection) {
+            if (level.board.size() > 2) {
+                levels.push_back(std::move(level));
+            }
+        }
+    }
+
+    return levels;
+}
+
+unsigned int LevelParser::number(const std::string &path) {
+    const std::string extension = ".xsb";
+    size_t end = path.size();
+
+    if (end < extension.size() ||
+        path.compare(end - extension.size(), extension.size(), extension)) {
+        throw std::invalid_argument(
+            "Could not parse level number from " + path
+        );
+    }
+
+    end -= extension.size();
+    size_t begin = end;
+
+    while (begin > 0 && std::isdigit((unsigned char) path[begin - 1])) {
+        begin--;
+    }
+
+    if (begin == end) {
+        throw std::invalid_argument(
+            "Could not parse level number from " + path
+        );
+    }
+
+    unsigned int number = 0;
+
+    for (size_t i = begin; i < end; i++) {
+        number = number * 10 + (path[i] - '0');
+    }
+
+    return number;
+}
@@ -0,0 +1,110 @@
+#ifndef __LEVEL_PARSER_H__
+#define __LEVEL_PARSER_H__
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "level.hpp"
+
+/**
+ * A single-pass parser for levels in the .xsb text format: a block of board
+ * rows followed by "Key: value" metadata lines, where a "Comment:" with no
+ * value opens a block that runs until "Comment-End:". Collections (.sok and
+ * .txt) are many such levels in one file, optionally after a header whose
+ * metadata applies to the whole collection.
+*/
+class LevelParser {
+    /**
+     * Split off the next line of a buffer
+     * @param std::string_view text the buffer
+     * @param size_t begin the offset of the line, moved past its ending
+     * @return std::string_view the line without its line ending
+    */
+    static std::string_view next_line(std::string_view text, size_t &begin);
+
+    /**
+     * Determine if a line is a board row: only Sokoban symbols, with at
+     * least one wall so that blank lines never count
+     * @param std::string_view line the line without its line ending
+     * @return bool true if the line is part of a board
+    */
+    static bool board_row(std::string_view line);
+
+    /**
+     * Remove leading and trailing spaces and tabs
+     * @param std::string_view text the text to trim
+     * @return std::string_view the trimmed text
+    */
+    static std::string_view trim(std::string_view text);
+
+    /**
+     * Compare a metadata key to a lowercase name, ignoring case
+     * @param std::string_view key the key as written
+     * @param std::string_view name the lowercase name
+     * @return bool true if they match
+    */
+    static bool key_equals(std::string_view key, std::string_view name);
+
+    /**
+     * Apply a metadata line to a level
+     * @param std::string_view line the line without its line ending
+     * @param Level level the level the metadata belongs to
+     * @param bool in_comment whether a comment block is open, updated
+    */
+    static void metadata(std::string_view line, Level &level,
+        bool &in_comment);
+
+public:
+    /**
+     * Parse the first level in a buffer
+     * @param std::string_view text the file contents
+     * @return Level the board and metadata; the board is empty if the
+     * text holds no level
+    */
+    static Level parse(std::string_view text);
+
+    /**
+     * Split a collection into the text of each level. Everything before the
+     * first board is the collection's header, and each level runs from its
+     * first board row up to the next board that follows other lines.
+     * Boards inside comment blocks don't start levels.
+     * @param std::string_view text the collection's contents
+     * @param std::string_view header set to the text before the first level
+     * @return std::vector<std::string_view> views of each level's text
+    */
+    static std::vector<std::string_view> split(std::string_view text,
+        std::string_view &header);
+
+    /**
+     * Parse every level in a collection, spreading the levels across
+     * threads. Levels without their own author take the collection
+     * header's.
+     * @param std::string_view text the collection's contents
+     * @param unsigned int threads the number of threads to use
+     * @return std::vector<Level> the levels in the order they appear
+    */
+    static std::vector<Level> parse_collection(std::string_view text,
+        unsigned int threads);
+
+    /**
+     * Read every level in a directory. Single-level files are ordered by
+     * the number in their names, followed by the levels of any .sok or
+     * .txt collections in path order, each in the order of its file. Each
+     * file is read with a single call and parsed in place, collections
+     * across threads. Boards of two rows or fewer are skipped.
+     * @param std::string path the directory
+     * @param unsigned int threads the number of threads for collections
+     * @return std::vector<Level> the levels
+    */
+    static std::vector<Level> read_directory(const std::string &path,
+        unsigned int threads);
+
+    /**
+     * Read the level number from a file name ending in digits and ".xsb"
+     * @param std::string path the path to the level file
+     * @return unsigned int the level number
+    */
+    static unsigned int number(const std::string &path);
+};
+#endif
@@ -0,0 +1,90 @@
+#include "level_store.hpp"
+
+#include <stdexcept>
+
+#include "trace.hpp"
+
+LevelStore::LevelStore(LevelPack pack)
+    : pack(std::move(pack)), boards(this->pack.size()) {
+}
+
+LevelStore::LevelStore(std::vector<std::vector<std::string>> levels) {
+    for (std::vector<std::string> &board : levels) {
+        add({std::move(board)});
+    }
+}
+
+void LevelStore::add(Level level) {
+    std::lock_guard<std::mutex> lock(mutex);
+    boards.push_back(std::make_shared<const std::vector<std::string>>(
+        std::move(level.board)
+    ));
+    extra.push_back(std::move(level));
+}
+
+void LevelStore::fill(unsigned int level, std::string_view cells) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (level >= pack.size()) {
+        throw std::invalid_argument(
+            "Level " + std::to_string(level) + " is not in the pack"
+        );
+    }
+
+    if (!pack.filled(level)) {
+        pack.fill(level, cells);
+    }
+}
+
+unsigned int LevelStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return boards.size();
+}
+
+LevelStore::Board LevelStore::board(unsigned int level) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (level >= boards.size()) {
+        throw std::invalid_argument(
+            "Level " + std::to_string(level) + " is not in the store"
+        );
+    }
+
+    if (!boards[level]) {
+        Trace::Scope trace("decode level", "engine");
+        trace.arg("level", level);
+        boards[level] = std::make_shared<const std::vector<std::string>>(
+            pack.board(level)
+        );
+    }
+
+    return boards[level];
+}
+
+const char *LevelStore::title(unsigned int level) const {
+    if (level < pack.size()) {
+        return pack.title(level);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (level - pack.size() >= extra.size()) {
+        return "";
+    }
+
+    return extra[level - pack.size()].title.c_str();
+}
+
+const char *LevelStore::author(unsigned int level) const {
+    if (level < pack.size()) {
+        return pack.author(level);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (level - pack.size() >= extra.size()) {
+        return "";
+    }
+
+    return extra[level - pack.size()].author.c_str();
+}
@@ -0,0 +1,99 @@
+#ifndef __LEVEL_STORE_H__
+#define __LEVEL_STORE_H__
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "level.hpp"
+#include "level_pack.hpp"
+
+/**
+ * The levels a game can be played on. Levels from a pack stay encoded until
+ * a board is first asked for, so building a store costs the same however
+ * large the collection is. Decoded boards are immutable and shared, both
+ * between callers and between the engines playing from the same store.
+*/
+class LevelStore {
+public:
+    /**
+     * A decoded starting board, shared read-only
+    */
+    using Board = std::shared_ptr<const std::vector<std::string>>;
+
+private:
+    LevelPack pack;
+
+    /**
+     * Metadata of the levels added after the pack, whose boards are
+     * decoded from the start. A deque never moves its elements, so the
+     * strings title() and author() return stay valid as levels are added.
+    */
+    std::deque<Level> extra;
+
+    /**
+     * Boards decoded so far, null until first asked for
+    */
+    mutable std::vector<Board> boards;
+    mutable std::mutex mutex;
+
+public:
+    /**
+     * Constructor which keeps a pack's levels encoded until they're played
+     * @param LevelPack pack the levels
+    */
+    LevelStore(LevelPack pack);
+
+    /**
+     * Constructor for levels that are already decoded
+     * @param std::vector<std::vector<std::string>> levels the boards
+    */
+    LevelStore(std::vector<std::vector<std::string>> levels);
+
+    /**
+     * Append a level after the others
+     * @param Level level the board and its metadata
+    */
+    void add(Level level);
+
+    /**
+     * Copy in the cells of a pack level that was left out when the pack
+     * was read; see LevelPack::fill(). A level already filled in keeps its
+     * cells.
+     * @param unsigned int level the level number
+     * @param std::string_view cells the level's bytes of the cells section
+    */
+    void fill(unsigned int level, std::string_view cells);
+
+    /**
+     * @return unsigned int the number of levels
+    */
+    unsigned int size() const;
+
+    /**
+     * Return a level's starting board, decoding it the first time. A pack
+     * level whose cells haven't been filled in is refused rather than
+     * decoded, so it plays normally once they arrive.
+     * @param unsigned int level the level number
+     * @return Board the board, shared with every other caller
+    */
+    Board board(unsigned int level) const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return const char * the level's title, or "" if there is none or
+     * the level isn't in the store
+    */
+    const char *title(unsigned int level) const;
+
+    /**
+     * @param unsigned int level the level number
+     * @return const char * the level's author, or "" if there is none or
+     * the level isn't in the store
+    */
+    const char *author(unsigned int level) const;
+};
+#endif
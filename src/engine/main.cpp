@@ -1,191 +1,515 @@
+#include <algorithm>
 #include <filesystem>
-#include <fstream>
-#include <map>
+#include <memory>
 #include <numeric>
-#include <regex>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
-#include "sokoban.hpp"
+#include "embedded_levels.hpp"
+#include "level_parser.hpp"
+#include "level_store.hpp"
+#include "session_pool.hpp"
+#include "trace.hpp"
 
-static Sokoban soko({{
+constexpr std::string_view start_level[] = {
     "#######",
     "#  $ .#",
     "#@  ###",
     "#####",
-}});
-static std::string joined_board;
-static std::string sequence_str;
-static std::vector<std::vector<std::string>> levels;
+};
+static_assert(EmbeddedLevels::valid(start_level),
+    "The start level is not playable");
+
+constexpr std::string_view test_level[] = {
+    "#####  ###",
+    "#.  ####.#",
+    "#$       #",
+    "#   ##   #",
+    "##      ##",
+    " #  *   #",
+    "##      ##",
+    "# @  $$$ #",
+    "#        #",
+    "#.#### . #",
+    "###  #####",
+};
+static_assert(EmbeddedLevels::valid(test_level),
+    "The test level is not playable");
+
+static std::shared_ptr<LevelStore> levels =
+    std::make_shared<LevelStore>(std::vector<std::vector<std::string>>{
+        {std::begin(start_level), std::end(start_level)},
+    });
+static SessionPool sessions;
+static std::string trace;
 
 /**
- * Reads all levels from a directory into the levels vector
- * @param path the path to the directory
+ * Load the level pack the build generated, or pack the level directory
+ * when there is no pack
+ * @param bool filled false if the pack's cells are still to be fetched
+ * @return LevelPack the levels
 */
-void read_levels(const std::string path = "src/engine/levels") {
-    std::map<int, std::vector<std::string>> ordered_levels;
-    std::filesystem::path levels_dir =
-        std::filesystem::directory_entry(path);
+LevelPack load_pack(bool filled) {
+    if (std::filesystem::exists("levels.pack")) {
+        return LevelPack::load("levels.pack", filled);
+    }
 
-    for (const auto& entry : std::filesystem::directory_iterator(levels_dir)) {
-        std::ifstream level_file(entry.path());
-        const std::string path = entry.path().u8string();
+    const unsigned int threads =
+        std::max(1u, std::thread::hardware_concurrency());
+    return LevelPack(LevelPack::encode(
+        LevelParser::read_directory("src/engine/levels", threads)
+    ));
+}
 
-        if (!level_file) {
-            throw std::invalid_argument("Cannot open file " + path);
-        }
+// Glue code to be called by the JS UI
+// to interact with the game engine
+extern "C" {
 
-        // Consider a line part of the level if it's comprised solely of Sokoban characters
-        const std::regex soko_elems_reg("[#@$*.+ ]+");
-        std::vector<std::string> level;
-
-        for (std::string line; std::getline(level_file, line);) {
-            if (std::regex_match(line, soko_elems_reg)) {
-                level.push_back(line);
-            }
-            else if (!level.empty()) { 
-                // The line wasn't all Sokoban characters and we've already found some level
-                break;
-            }
-        }
+/**
+ * Initializes the Sokoban game with the levels compiled into the embedded
+ * build, or else with the level pack. Only the pack's index is read up
+ * front; each level is decoded the first time it's played. Sessions
+ * created before this keep playing the levels they started with.
+ * @param bool fetching true if the pack was written with its cells left
+ * as zeros, so that each level waits for sokoban_fill_level()
+*/
+void sokoban_initialize(bool fetching) {
+    levels = std::make_shared<LevelStore>(
+        EmbeddedLevels::count > 0 ? LevelPack() : load_pack(!fetching)
+    );
 
-        if (level.size() > 2) {
-            const std::regex level_num_reg("(\\d+)\\.xsb$");
-            std::smatch match;
-
-            if (std::regex_search(path, match, level_num_reg)) {
-                ordered_levels[std::stoi(match[1])] = level;
-            }
-            else {
-                auto msg = "Could not parse level number from " + path;
-                throw std::invalid_argument(msg);
-            }
-        }
+    for (Level &level : EmbeddedLevels::levels()) {
+        levels->add(std::move(level));
     }
 
-    for (auto &[_, level] : ordered_levels) {
-        levels.push_back(level);
-    }
+    levels->add({
+        {std::begin(test_level), std::end(test_level)}, "", "Test", ""
+    });
 }
 
-// Glue code to be called by the JS UI
-// to interact with the game engine
-extern "C" {
+/**
+ * Start a new game on the first level. Every session shares the same
+ * decoded levels.
+ * @return int the handle to pass to every other call for this game
+*/
+int sokoban_create() {
+    return sessions.create(levels);
+}
 
 /**
- * Initializes the Sokoban game by reading the levels
+ * End a game, after which its handle is no longer valid. A call given a
+ * handle that is stale or was never issued does nothing; calls returning
+ * a bool return false, strings "", sokoban_changes() a null pointer,
+ * sokoban_move_batch() 0 and the other numbers -1.
+ * @param int session the game's handle
 */
-void sokoban_initialize() {
-    read_levels();
-    std::vector<std::string> test_level = {
-        "#####  ###",
-        "#.  ####.#",
-        "#$       #",
-        "#   ##   #",
-        "##      ##",
-        " #  *   #",
-        "##      ##",
-        "# @  $$$ #",
-        "#        #",
-        "#.#### . #",
-        "###  #####",
-    };
-    levels.push_back(test_level);
-    soko = {levels};
+void sokoban_destroy(int session) {
+    if (sessions.find(session)) {
+        sessions.destroy(session);
+    }
 }
 
 /**
  * Stringifies the current Sokoban board
+ * @param int session the game's handle
  * @return const char * the board delimited by newlines
 */
-const char *sokoban_board_to_string() {
-    auto board = soko.board();
-    joined_board = std::accumulate(
+const char *sokoban_board_to_string(int session) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return "";
+    }
+
+    auto board = game->soko.board();
+    game->board = std::accumulate(
         std::begin(board), std::end(board), std::string(),
         [](std::string &ss, std::string &s)
         { return ss.empty() ? s : ss + "\n" + s; }
     );
-    return joined_board.c_str();
+    return game->board.c_str();
 }
 
 /**
  * Moves the player in a direction relative to their current location
+ * @param int session the game's handle
  * @param char *s "u", "d", "l", "r" corresponding to the 4 directions
  * @return bool true if the move modified the board, false otherwise
 */
-bool sokoban_move(char *s) {
-    return soko.move((Sokoban::Direction) *s);
+bool sokoban_move(int session, char *s) {
+    Session *game = sessions.find(session);
+    return game && game->soko.move((Sokoban::Direction) *s);
+}
+
+/**
+ * Make queued moves in one call, skipping blocked ones, and record the
+ * cells they changed for sokoban_changes()
+ * @param int session the game's handle
+ * @param const char * directions "U", "D", "L" or "R" for each move
+ * @return int the number of cells changed, 0 if no move was made or a
+ * direction is invalid
+*/
+int sokoban_move_batch(int session, const char *directions) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return 0;
+    }
+
+    game->changes.clear();
+
+    try {
+        for (const Sokoban::Change &change :
+                game->soko.move_batch(directions)) {
+            game->changes.insert(game->changes.end(),
+                {(int) change.y, (int) change.x, change.cell});
+        }
+    }
+    catch (const std::invalid_argument &) {
+        return 0;
+    }
+
+    return game->changes.size() / 3;
+}
+
+/**
+ * Return the cells the last sokoban_move_batch() changed, as the row,
+ * column and new symbol of each, three ints per cell
+ * @param int session the game's handle
+ * @return const int * the cells, valid until the next batch
+*/
+const int *sokoban_changes(int session) {
+    Session *game = sessions.find(session);
+    return game ? game->changes.data() : nullptr;
 }
 
 /**
  * Moves the player to row, col if possible
+ * @param int session the game's handle
  * @param int row the row to move to
  * @param int col the column to move to
  * @return bool true if the move modified the board, false otherwise
 */
-bool sokoban_goto(int row, int col) {
-    return soko.move(row, col);
+bool sokoban_goto(int session, int row, int col) {
+    Session *game = sessions.find(session);
+    return game && game->soko.move(row, col);
 }
 
 /**
  * Determine if the board is in a solved state
+ * @param int session the game's handle
  * @return bool true if solved false otherwise
 */
-bool sokoban_solved() {
-    return soko.solved();
+bool sokoban_solved(int session) {
+    Session *game = sessions.find(session);
+    return game && game->soko.solved();
 }
 
 /**
  * Undo the last move, if possible
+ * @param int session the game's handle
  * @return bool true if the undo modified the board, false otherwise
 */
-bool sokoban_undo() {
-    return soko.undo();
+bool sokoban_undo(int session) {
+    Session *game = sessions.find(session);
+    return game && game->soko.undo();
+}
+
+/**
+ * Return the node of the current position in the tree of every line
+ * explored on the level; the level's start is node 0
+ * @param int session the game's handle
+ * @return int the current node
+*/
+int sokoban_node(int session) {
+    Session *game = sessions.find(session);
+    return game ? (int) game->soko.node() : -1;
+}
+
+/**
+ * Return the node a node's move was made from
+ * @param int session the game's handle
+ * @param int node a node in the tree
+ * @return int the parent, or 0 for the root
+*/
+int sokoban_parent(int session, int node) {
+    Session *game = sessions.find(session);
+    return game ? (int) game->soko.parent(node) : -1;
+}
+
+/**
+ * Return one of the variations played from a node
+ * @param int session the game's handle
+ * @param int node a node in the tree
+ * @param int i the index of the variation, oldest first
+ * @return int the variation's first node, or 0 if there are no more
+*/
+int sokoban_variation(int session, int node, int i) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return -1;
+    }
+
+    const std::vector<unsigned int> children = game->soko.variations(node);
+    return i >= 0 && i < (int) children.size() ? children[i] : 0;
+}
+
+/**
+ * Go to any explored position, taking as many steps as lie between it
+ * and the current one
+ * @param int session the game's handle
+ * @param int node the node to go to
+ * @return bool true if the node exists, false otherwise
+*/
+bool sokoban_jump(int session, int node) {
+    Session *game = sessions.find(session);
+    return game && game->soko.jump(node);
 }
 
 /**
  * Reset the current level to its original state
+ * @param int session the game's handle
 */
-void sokoban_reset() {
-    soko.reset();
+void sokoban_reset(int session) {
+    if (Session *game = sessions.find(session)) {
+        game->soko.reset();
+    }
 }
 
 /**
  * Return the sequence of moves ("u", "d", "l", "r") 
  * applied so far on the level
+ * @param int session the game's handle
  * @return const char * the moves string
 */
-const char *sokoban_sequence() {
-    sequence_str = soko.sequence();
-    return sequence_str.c_str();
+const char *sokoban_sequence(int session) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return "";
+    }
+
+    game->sequence = game->soko.sequence();
+    return game->sequence.c_str();
+}
+
+/**
+ * Return the number of moves made so far on the level
+ * @param int session the game's handle
+ * @return int the number of moves
+*/
+int sokoban_moves(int session) {
+    Session *game = sessions.find(session);
+    return game ? (int) game->soko.moves() : -1;
+}
+
+/**
+ * Return the number of moves so far on the level that pushed a box
+ * @param int session the game's handle
+ * @return int the number of pushes
+*/
+int sokoban_pushes(int session) {
+    Session *game = sessions.find(session);
+    return game ? (int) game->soko.pushes() : -1;
+}
+
+/**
+ * Return the engine's counters, which only builds compiled with
+ * -DSOKOBAN_STATS keep
+ * @param int session the game's handle
+ * @return const char * a JSON object of the Sokoban::Stats fields, all 0
+ * in other builds
+*/
+const char *sokoban_stats(int session) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return "";
+    }
+
+    const Sokoban::Stats stats = game->soko.stats();
+    game->stats = "{\"moves\": " + std::to_string(stats.moves) +
+        ", \"pushes\": " + std::to_string(stats.pushes) +
+        ", \"undos\": " + std::to_string(stats.undos) +
+        ", \"redos\": " + std::to_string(stats.redos) +
+        ", \"walk_nodes\": " + std::to_string(stats.walk_nodes) +
+        ", \"history_bytes\": " + std::to_string(stats.history_bytes) +
+        "}";
+    return game->stats.c_str();
+}
+
+/**
+ * Start recording level loads and walks as trace events, discarding any
+ * earlier trace; only builds compiled with -DSOKOBAN_STATS record them
+*/
+void sokoban_trace_start() {
+    Trace::start();
+}
+
+/**
+ * Stop recording and return the trace
+ * @return const char * the events as Chrome trace-event JSON, valid until
+ * the next call
+*/
+const char *sokoban_trace_stop() {
+    Trace::stop();
+    trace = Trace::json();
+    return trace.c_str();
+}
+
+/**
+ * Return the next move towards solving the current board. The solution is
+ * cached per level, so hints along it are a lookup and straying from it
+ * only costs a short search back to the line.
+ * @param int session the game's handle
+ * @return const char * "u", "d", "l", "r" for a move, "U", "D", "L", "R"
+ * for a push, or "" when solved or no solution was found
+*/
+const char *sokoban_hint(int session) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return "";
+    }
+
+    const unsigned int level = game->soko.level();
+
+    if (!game->hint || game->hint_level != level) {
+        game->hint = std::make_unique<Hint>(*game->levels->board(level));
+        game->hint_level = level;
+    }
+
+    const char move = game->hint->next(game->soko.board());
+    game->hint_move = move ? std::string(1, move) : "";
+    return game->hint_move.c_str();
 }
 
 /**
  * Return the current level number being played
- * int level the level number
+ * @param int session the game's handle
+ * @return int the level number
 */
-int sokoban_level() {
-    return soko.level();
+int sokoban_level(int session) {
+    Session *game = sessions.find(session);
+    return game ? (int) game->soko.level() : -1;
 }
 
 /**
  * Set the current level if possible
+ * @param int session the game's handle
  * @param int level the level number to switch to
 */
-void sokoban_change_level(int level) {
-    soko.change_level(level);
+void sokoban_change_level(int session, int level) {
+    if (Session *game = sessions.find(session)) {
+        game->soko.change_level(level);
+    }
 }
 
 /**
- * Return the number of levels in the levels vector
- * @return int the size of the levels vector
+ * Save the game as a binary blob that sokoban_deserialize() restores
+ * without replaying it. Read sokoban_serialized_size() bytes from the
+ * returned pointer; the blob may contain zero bytes.
+ * @param int session the game's handle
+ * @return const char * the blob, valid until the next call
+*/
+const char *sokoban_serialize(int session) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return "";
+    }
+
+    game->state = game->soko.serialize();
+    return game->state.data();
+}
+
+/**
+ * Return the length of the blob the last sokoban_serialize() returned
+ * @param int session the game's handle
+ * @return int the blob's length in bytes
+*/
+int sokoban_serialized_size(int session) {
+    Session *game = sessions.find(session);
+    return game ? (int) game->state.size() : -1;
+}
+
+/**
+ * Restore a game saved by sokoban_serialize(), possibly from another
+ * session or process sharing the same levels
+ * @param int session the game's handle
+ * @param const char * blob the saved game
+ * @param int size the blob's length in bytes
+ * @return bool true if the game was restored, false if the blob was
+ * rejected and the game left as it was
+*/
+bool sokoban_deserialize(int session, const char *blob, int size) {
+    Session *game = sessions.find(session);
+
+    if (!game) {
+        return false;
+    }
+
+    try {
+        game->soko.deserialize(std::string(blob, size));
+        return true;
+    }
+    catch (const std::invalid_argument &) {
+        return false;
+    }
+}
+
+/**
+ * Copy in the cells of a level that the page fetched after the pack's
+ * index, before the level is first played
+ * @param int level the level number
+ * @param const char * cells the level's bytes of the pack's cells section
+ * @param int size the number of bytes
+ * @return bool true if the cells were copied in, false if the level isn't
+ * in the pack or the cells don't fit it
+*/
+bool sokoban_fill_level(int level, const char *cells, int size) {
+    try {
+        levels->fill(level, std::string_view(cells, size));
+        return true;
+    }
+    catch (const std::invalid_argument &) {
+        return false;
+    }
+}
+
+/**
+ * Return the number of levels in the store
+ * @return int the number of levels
 */
 int sokoban_levels_size() {
-    return levels.size();
+    return levels->size();
+}
+
+/**
+ * Return the title a level's file gave it
+ * @param int level the level number
+ * @return const char * the title, or "" if there is none or no such level
+*/
+const char *sokoban_level_title(int level) {
+    return levels->title(level);
+}
+
+/**
+ * Return the author a level's file credits
+ * @param int level the level number
+ * @return const char * the author, or "" if there is none or no such level
+*/
+const char *sokoban_level_author(int level) {
+    return levels->author(level);
 }
 
 } // extern "C"
 
 int main() {
+    return 0;
 }
 
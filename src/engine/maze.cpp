@@ -0,0 +1,387 @@
+#include "maze.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+#include "trace.hpp"
+
+bool Maze::State::operator==(const State &other) const {
+    return player == other.player && boxes == other.boxes;
+}
+
+size_t Maze::StateHash::operator() (const State &state) const {
+    size_t hash = 14695981039346656037ull;
+
+    hash = (hash ^ state.player) * 1099511628211ull;
+
+    for (const unsigned short box : state.boxes) {
+        hash = (hash ^ box) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+Maze::Maze(const std::vector<std::string> &board) {
+    Trace::Scope trace("preprocess", "solver");
+    size_t longest = 0;
+
+    for (const std::string &row : board) {
+        longest = std::max(longest, row.size());
+    }
+
+    _width = longest + 2;
+    offsets[0] = -(int) _width;
+    offsets[1] = _width;
+    offsets[2] = -1;
+    offsets[3] = 1;
+
+    const unsigned int cells = _width * (board.size() + 2);
+
+    if (cells > 0xffff) {
+        throw std::invalid_argument("Board is too large to solve");
+    }
+
+    walls.assign(cells, true);
+    goals.assign(cells, false);
+    floor = Bitboard(cells, _width);
+    start_player = 0;
+
+    for (unsigned int y = 0; y < board.size(); y++) {
+        for (unsigned int x = 0; x < board[y].size(); x++) {
+            const char symbol = board[y][x];
+            const unsigned short index = cell(y, x);
+
+            walls[index] = symbol == '#';
+
+            if (!walls[index]) {
+                floor.set(index);
+            }
+            goals[index] = symbol == '.' || symbol == '*' || symbol == '+';
+
+            if (symbol == '$' || symbol == '*') {
+                start_boxes.push_back(index);
+            }
+            else if (symbol == '@' || symbol == '+') {
+                start_player = index;
+            }
+        }
+    }
+
+    if (start_player == 0) {
+        throw std::invalid_argument("Player not found...");
+    }
+
+    if (start_boxes.size() != goal_count()) {
+        throw std::invalid_argument("Box and goal counts differ");
+    }
+
+    compute_distances();
+}
+
+void Maze::compute_distances() {
+    Trace::Scope trace("dead squares", "solver");
+    std::queue<unsigned int> queue;
+    distances.assign(size(), unreachable);
+
+    for (unsigned int i = 0; i < size(); i++) {
+        if (goals[i]) {
+            distances[i] = 0;
+            queue.push(i);
+        }
+    }
+
+    // A box reaches cell from cell - offset if the player fits behind it
+    while (!queue.empty()) {
+        const unsigned int current = queue.front();
+        queue.pop();
+
+        for (const int offset : offsets) {
+            const int from = current - offset;
+            const int player = from - offset;
+
+            if (player < 0 || player >= (int) size() ||
+                walls[from] || walls[player] ||
+                distances[from] != unreachable) {
+                continue;
+            }
+
+            distances[from] = distances[current] + 1;
+            queue.push(from);
+        }
+    }
+}
+
+bool Maze::frozen(const Bitboard &occupied, unsigned int cell) const {
+    const unsigned int corners[4][3] = {
+        {cell - 1, cell - _width, cell - _width - 1},
+        {cell + 1, cell - _width, cell - _width + 1},
+        {cell - 1, cell + _width, cell + _width - 1},
+        {cell + 1, cell + _width, cell + _width + 1},
+    };
+
+    for (const auto &square : corners) {
+        bool blocked = true;
+        bool stuck = !goals[cell];
+
+        for (const unsigned int other : square) {
+            blocked = blocked && (walls[other] || occupied.test(other));
+            stuck = stuck || (occupied.test(other) && !goals[other]);
+        }
+
+        if (blocked && stuck) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+unsigned int Maze::size() const {
+    return walls.size();
+}
+
+unsigned int Maze::width() const {
+    return _width;
+}
+
+std::pair<unsigned int, unsigned int> Maze::coordinates(
+    unsigned int cell
+) const {
+    return std::make_pair(cell / _width - 1, cell % _width - 1);
+}
+
+unsigned int Maze::cell(unsigned int y, unsigned int x) const {
+    return (y + 1) * _width + x + 1;
+}
+
+int Maze::offset(unsigned int direction) const {
+    return offsets[direction];
+}
+
+bool Maze::wall(unsigned int cell) const {
+    return walls[cell];
+}
+
+bool Maze::goal(unsigned int cell) const {
+    return goals[cell];
+}
+
+Maze::State Maze::initial() const {
+    return {normalize(start_player, occupancy(start_boxes)), start_boxes};
+}
+
+unsigned int Maze::start() const {
+    return start_player;
+}
+
+Maze::State Maze::state(const std::vector<std::string> &board) const {
+    State state = position(board);
+    state.player = normalize(state.player, occupancy(state.boxes));
+    return state;
+}
+
+Maze::State Maze::position(const std::vector<std::string> &board) const {
+    State position{0, {}};
+
+    for (unsigned int y = 0; y < board.size(); y++) {
+        for (unsigned int x = 0; x < board[y].size(); x++) {
+            const char symbol = board[y][x];
+
+            if (symbol == '$' || symbol == '*') {
+                position.boxes.push_back(cell(y, x));
+            }
+            else if (symbol == '@' || symbol == '+') {
+                position.player = cell(y, x);
+            }
+        }
+    }
+
+    return position;
+}
+
+char Maze::step(State &position, unsigned int direction) const {
+    const unsigned int next = position.player + offsets[direction];
+    auto &boxes = position.boxes;
+    const auto box = std::lower_bound(boxes.begin(), boxes.end(), next);
+
+    if (walls[next]) {
+        return 0;
+    }
+
+    if (box == boxes.end() || *box != next) {
+        position.player = next;
+        return walks[direction];
+    }
+
+    const unsigned int target = next + offsets[direction];
+
+    if (walls[target] ||
+        std::binary_search(boxes.begin(), boxes.end(), target)) {
+        return 0;
+    }
+
+    *box = target;
+    std::sort(boxes.begin(), boxes.end());
+    position.player = next;
+    return pushes[direction];
+}
+
+unsigned int Maze::goal_count() const {
+    return std::count(goals.begin(), goals.end(), true);
+}
+
+bool Maze::solved(const State &state) const {
+    return std::all_of(state.boxes.begin(), state.boxes.end(),
+        [&](unsigned short box) { return goals[box]; });
+}
+
+unsigned int Maze::heuristic(const State &state) const {
+    unsigned int estimate = 0;
+
+    for (const unsigned short box : state.boxes) {
+        if (distances[box] == unreachable) {
+            return unreachable;
+        }
+
+        estimate += distances[box];
+    }
+
+    return estimate;
+}
+
+Bitboard Maze::reach(unsigned int player, const Bitboard &occupied) const {
+    Bitboard open = floor;
+    open.subtract(occupied);
+    return open.flood(player);
+}
+
+unsigned short Maze::normalize(
+    unsigned int player,
+    const Bitboard &occupied
+) const {
+    return reach(player, occupied).first();
+}
+
+Bitboard Maze::occupancy(const std::vector<unsigned short> &boxes) const {
+    Bitboard occupied(size(), _width);
+
+    for (const unsigned short box : boxes) {
+        occupied.set(box);
+    }
+
+    return occupied;
+}
+
+std::vector<Maze::Successor> Maze::successors(
+    const State &state,
+    unsigned int *deadlocks
+) const {
+    std::vector<Successor> result;
+    Bitboard occupied = occupancy(state.boxes);
+    Bitboard open = floor;
+    open.subtract(occupied);
+    const Bitboard region = open.flood(state.player);
+
+    for (unsigned int i = 0; i < state.boxes.size(); i++) {
+        const unsigned short box = state.boxes[i];
+
+        for (unsigned char direction = 0; direction < 4; direction++) {
+            const unsigned int target = box + offsets[direction];
+
+            if (!region.test(box - offsets[direction]) || walls[target] ||
+                occupied.test(target) || distances[target] == unreachable) {
+                continue;
+            }
+
+            occupied.reset(box);
+            occupied.set(target);
+
+            const bool stuck = frozen(occupied, target);
+
+            if (stuck && deadlocks) {
+                (*deadlocks)++;
+            }
+
+            if (!stuck) {
+                // The player stands where the box was
+                open.set(box);
+                open.reset(target);
+                State next{(unsigned short) open.flood(box).first(),
+                    state.boxes};
+                next.boxes[i] = target;
+                std::sort(next.boxes.begin(), next.boxes.end());
+                result.push_back({{box, direction}, std::move(next)});
+                open.set(target);
+                open.reset(box);
+            }
+
+            occupied.reset(target);
+            occupied.set(box);
+        }
+    }
+
+    return result;
+}
+
+std::string Maze::walk(
+    unsigned int from,
+    unsigned int to,
+    const Bitboard &occupied
+) const {
+    std::vector<int> parents(size(), -1);
+    std::queue<unsigned int> queue;
+    queue.push(from);
+    parents[from] = from;
+
+    while (!queue.empty() && parents[to] < 0) {
+        const unsigned int current = queue.front();
+        queue.pop();
+
+        for (const int offset : offsets) {
+            const unsigned int next = current + offset;
+
+            if (parents[next] < 0 && !walls[next] && !occupied.test(next)) {
+                parents[next] = current;
+                queue.push(next);
+            }
+        }
+    }
+
+    if (parents[to] < 0) {
+        throw std::invalid_argument("No walk between cells");
+    }
+
+    std::string path;
+
+    for (unsigned int current = to; current != from;) {
+        const unsigned int parent = parents[current];
+        const int step = current - parent;
+        const int *direction = std::find(offsets, offsets + 4, step);
+        path.push_back(walks[direction - offsets]);
+        current = parent;
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+std::string Maze::moves(
+    unsigned int player,
+    std::vector<unsigned short> boxes,
+    const std::vector<Push> &line
+) const {
+    std::string solution;
+
+    for (const Push &push : line) {
+        const int offset = offsets[push.direction];
+        const Bitboard occupied = occupancy(boxes);
+
+        solution += walk(player, push.box - offset, occupied);
+        solution.push_back(pushes[push.direction]);
+        *std::find(boxes.begin(), boxes.end(), push.box) = push.box + offset;
+        player = push.box;
+    }
+
+    return solution;
+}
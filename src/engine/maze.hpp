@@ -0,0 +1,283 @@
+#ifndef __MAZE_H__
+#define __MAZE_H__
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bitboard.hpp"
+
+/**
+ * The static part of a Sokoban level (walls, goals, dead squares and push
+ * distances) flattened into a single row-major array of cells, together with
+ * the operations a solver needs to walk the space of box configurations.
+ *
+ * The grid is surrounded by an extra ring of walls so that neighbor lookups
+ * never need bounds checks.
+*/
+class Maze {
+public:
+    /**
+     * A position in push-space: the sorted box cells and the player cell,
+     * normalized to the smallest cell index the player can reach. Exact
+     * positions use the same type with the player's actual cell.
+    */
+    struct State {
+        unsigned short player;
+        std::vector<unsigned short> boxes;
+
+        bool operator==(const State &other) const;
+    };
+
+    /**
+     * Hashing for states which mixes the player and every box cell
+    */
+    struct StateHash {
+        size_t operator() (const State &state) const;
+    };
+
+    /**
+     * A single box push: the cell the box is on and the direction index
+     * (0-3, in "UDLR" order) it is pushed in
+    */
+    struct Push {
+        unsigned short box;
+        unsigned char direction;
+    };
+
+    /**
+     * A push together with the state it leads to
+    */
+    struct Successor {
+        Push push;
+        State state;
+    };
+
+    /**
+     * The LURD characters for walking (lowercase) and pushing (uppercase),
+     * indexed by direction
+    */
+    static constexpr const char *walks = "udlr";
+    static constexpr const char *pushes = "UDLR";
+
+    /**
+     * Marker for a cell from which no goal can be reached
+    */
+    static constexpr unsigned int unreachable = ~0u;
+
+private:
+    /**
+     * Width of the padded grid, the row stride of every cell index
+    */
+    unsigned int _width;
+
+    /**
+     * Cell offsets for each direction in "UDLR" order
+    */
+    int offsets[4];
+
+    /**
+     * Per-cell flags for the padded grid
+    */
+    std::vector<bool> walls;
+    std::vector<bool> goals;
+
+    /**
+     * The cells that aren't walls, for flood fills a word at a time
+    */
+    Bitboard floor;
+
+    /**
+     * Minimum number of pushes needed to bring a box from each cell to any
+     * goal, ignoring other boxes; unreachable for dead squares
+    */
+    std::vector<unsigned int> distances;
+
+    /**
+     * The level's starting position, with the player not yet normalized
+    */
+    unsigned short start_player;
+    std::vector<unsigned short> start_boxes;
+
+    /**
+     * Computes distances with a reverse (pulling) breadth-first search
+     * from every goal
+    */
+    void compute_distances();
+
+    /**
+     * Determine if a box just pushed to cell forms a 2x2 block of walls and
+     * boxes that can never move again while off a goal
+     * @param Bitboard occupied box occupancy after the push
+     * @param unsigned int cell the cell the box arrived on
+     * @return bool true if the position is frozen, false otherwise
+    */
+    bool frozen(const Bitboard &occupied, unsigned int cell) const;
+
+public:
+    /**
+     * Constructor which parses a board in the same format Sokoban uses
+     * @param std::vector<std::string> board the rows of the level
+    */
+    Maze(const std::vector<std::string> &board);
+
+    /**
+     * Return the number of cells in the padded grid
+     * @return unsigned int the cell count
+    */
+    unsigned int size() const;
+
+    /**
+     * Return the row stride of the padded grid
+     * @return unsigned int the width
+    */
+    unsigned int width() const;
+
+    /**
+     * Convert a padded cell index back to board row and column
+     * @param unsigned int cell the cell index
+     * @return std::pair<unsigned int, unsigned int> the row and column
+    */
+    std::pair<unsigned int, unsigned int> coordinates(unsigned int cell) const;
+
+    /**
+     * Convert board row and column to a padded cell index
+     * @param unsigned int y the row
+     * @param unsigned int x the column
+     * @return unsigned int the cell index
+    */
+    unsigned int cell(unsigned int y, unsigned int x) const;
+
+    /**
+     * Return the cell offset of a direction
+     * @param unsigned int direction the direction index in "UDLR" order
+     * @return int the offset to add to a cell index
+    */
+    int offset(unsigned int direction) const;
+
+    /**
+     * Determine if a cell is a wall (including the padding ring)
+     * @param unsigned int cell the cell index
+     * @return bool true if the cell is a wall
+    */
+    bool wall(unsigned int cell) const;
+
+    /**
+     * Determine if a cell is a goal
+     * @param unsigned int cell the cell index
+     * @return bool true if the cell is a goal
+    */
+    bool goal(unsigned int cell) const;
+
+    /**
+     * Return the normalized starting state of the level
+     * @return State the initial state
+    */
+    State initial() const;
+
+    /**
+     * Return the cell the player actually starts on
+     * @return unsigned int the cell index
+    */
+    unsigned int start() const;
+
+    /**
+     * Build a state from a board in Sokoban's row format
+     * @param std::vector<std::string> board the rows to read
+     * @return State the normalized state
+    */
+    State state(const std::vector<std::string> &board) const;
+
+    /**
+     * Build an exact position from a board in Sokoban's row format, with
+     * the player on their actual cell
+     * @param std::vector<std::string> board the rows to read
+     * @return State the exact position
+    */
+    State position(const std::vector<std::string> &board) const;
+
+    /**
+     * Apply a single move to an exact position
+     * @param State position the position to change
+     * @param unsigned int direction the direction index in "UDLR" order
+     * @return char the LURD character for the move, or 0 if it is blocked
+    */
+    char step(State &position, unsigned int direction) const;
+
+    /**
+     * Return the number of goals in the level
+     * @return unsigned int the goal count
+    */
+    unsigned int goal_count() const;
+
+    /**
+     * Determine if every box of the state rests on a goal
+     * @param State state the state to check
+     * @return bool true if solved false otherwise
+    */
+    bool solved(const State &state) const;
+
+    /**
+     * Admissible estimate of the pushes left to solve a state
+     * @param State state the state to estimate
+     * @return unsigned int the lower bound, or unreachable if a box is dead
+    */
+    unsigned int heuristic(const State &state) const;
+
+    /**
+     * Flood fill the cells the player can walk to without pushing
+     * @param unsigned int player the player's cell
+     * @param Bitboard occupied box occupancy
+     * @return Bitboard the reachable cells
+    */
+    Bitboard reach(unsigned int player, const Bitboard &occupied) const;
+
+    /**
+     * Return the smallest cell index the player can reach, which identifies
+     * the player's region independently of where in it they stand
+     * @param unsigned int player the player's cell
+     * @param Bitboard occupied box occupancy
+     * @return unsigned short the normalized player cell
+    */
+    unsigned short normalize(unsigned int player,
+        const Bitboard &occupied) const;
+
+    /**
+     * Mark the cells holding boxes
+     * @param std::vector<unsigned short> boxes the box cells
+     * @return Bitboard the occupancy of every cell
+    */
+    Bitboard occupancy(const std::vector<unsigned short> &boxes) const;
+
+    /**
+     * Generate every live state one push away
+     * @param State state the state to expand
+     * @param unsigned int * deadlocks if given, counts the pushes left out
+     * because they freeze a box off its goal
+     * @return std::vector<Successor> the pushes and their resulting states
+    */
+    std::vector<Successor> successors(const State &state,
+        unsigned int *deadlocks = nullptr) const;
+
+    /**
+     * Return the shortest walk between two cells as lowercase LURD
+     * @param unsigned int from the starting cell
+     * @param unsigned int to the destination cell
+     * @param Bitboard occupied box occupancy
+     * @return std::string the moves, empty if from == to
+    */
+    std::string walk(unsigned int from, unsigned int to,
+        const Bitboard &occupied) const;
+
+    /**
+     * Convert a line of pushes from a starting position into a full LURD
+     * solution, walking the player to each push
+     * @param unsigned int player the player's actual starting cell
+     * @param std::vector<unsigned short> boxes the starting box cells
+     * @param std::vector<Push> line the pushes in order
+     * @return std::string the moves and pushes
+    */
+    std::string moves(unsigned int player, std::vector<unsigned short> boxes,
+        const std::vector<Push> &line) const;
+};
+#endif
@@ -0,0 +1,88 @@
+#include "move_sequence.hpp"
+
+#include <cstring>
+
+const char MoveSequence::codes[] = "UDLR";
+
+void MoveSequence::push_back(const Step &step) {
+    const unsigned int i = pushed.size();
+
+    if (i % 4 == 0) {
+        directions.push_back(0);
+    }
+
+    const unsigned int code = std::strchr(codes, step.direction) - codes;
+    directions.back() |= code << (i % 4 * 2);
+    pushed.push_back(step.push);
+    fast_forwarded.push_back(step.fast_forward);
+    push_count += step.push;
+}
+
+void MoveSequence::pop_back() {
+    if (empty()) {
+        return;
+    }
+
+    const unsigned int i = pushed.size() - 1;
+    push_count -= pushed.back();
+    pushed.pop_back();
+    fast_forwarded.pop_back();
+
+    // Clear the code so the byte can be filled again
+    if (i % 4 == 0) {
+        directions.pop_back();
+    }
+    else {
+        directions.back() &= ~(3 << (i % 4 * 2));
+    }
+}
+
+void MoveSequence::clear() {
+    directions.clear();
+    pushed.clear();
+    fast_forwarded.clear();
+    push_count = 0;
+}
+
+MoveSequence::Step MoveSequence::operator[](unsigned int i) const {
+    return {
+        codes[directions[i / 4] >> (i % 4 * 2) & 3],
+        pushed[i],
+        fast_forwarded[i],
+    };
+}
+
+MoveSequence::Step MoveSequence::back() const {
+    return (*this)[size() - 1];
+}
+
+void MoveSequence::mark_back(bool fast_forward) {
+    fast_forwarded.back() = fast_forward;
+}
+
+unsigned int MoveSequence::size() const {
+    return pushed.size();
+}
+
+unsigned int MoveSequence::pushes() const {
+    return push_count;
+}
+
+unsigned long MoveSequence::bytes() const {
+    return directions.capacity() +
+        (pushed.capacity() + fast_forwarded.capacity()) / 8;
+}
+
+bool MoveSequence::empty() const {
+    return pushed.empty();
+}
+
+std::string MoveSequence::str() const {
+    std::string sequence(size(), '\0');
+
+    for (unsigned int i = 0; i < sequence.size(); i++) {
+        sequence[i] = codes[directions[i / 4] >> (i % 4 * 2) & 3];
+    }
+
+    return sequence;
+}
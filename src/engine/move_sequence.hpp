@@ -0,0 +1,103 @@
+#ifndef __MOVE_SEQUENCE_H__
+#define __MOVE_SEQUENCE_H__
+
+#include <string>
+#include <vector>
+
+/**
+ * The moves made on a level, packed 2 bits to a direction with a bit each
+ * for whether the move pushed a box and whether it ended a fast-forward.
+ * The number of moves and pushes are kept as the sequence changes, so
+ * reading them costs nothing, and the LURD string is only built on request.
+*/
+class MoveSequence {
+public:
+    /**
+     * A move as the sequence keeps it: enough to take it back without a
+     * copy of the board
+    */
+    struct Step {
+        char direction;
+        bool push;
+
+        /**
+         * Marks the end of a multi-step move, which a rewind treats as a
+         * single operation
+        */
+        bool fast_forward;
+    };
+
+private:
+    std::vector<unsigned char> directions;
+    std::vector<bool> pushed;
+    std::vector<bool> fast_forwarded;
+    unsigned int push_count = 0;
+
+public:
+    /**
+     * The directions in the order of their 2-bit codes
+    */
+    static const char codes[];
+
+    /**
+     * Append a move
+     * @param Step step the move, with a direction of 'U', 'D', 'L' or 'R'
+    */
+    void push_back(const Step &step);
+
+    /**
+     * Remove the last move, if there is one
+    */
+    void pop_back();
+
+    /**
+     * Remove every move
+    */
+    void clear();
+
+    /**
+     * Return a move
+     * @param unsigned int i the index of the move, which must exist
+     * @return Step the move
+    */
+    Step operator[](unsigned int i) const;
+
+    /**
+     * Return the last move, which must exist
+     * @return Step the move
+    */
+    Step back() const;
+
+    /**
+     * Set whether the last move, which must exist, ends a fast-forward
+     * @param bool fast_forward the new mark
+    */
+    void mark_back(bool fast_forward);
+
+    /**
+     * @return unsigned int the number of moves
+    */
+    unsigned int size() const;
+
+    /**
+     * @return unsigned int the number of moves that pushed a box
+    */
+    unsigned int pushes() const;
+
+    /**
+     * @return unsigned long the heap bytes the sequence holds
+    */
+    unsigned long bytes() const;
+
+    /**
+     * @return bool true if no move has been made
+    */
+    bool empty() const;
+
+    /**
+     * Build the directions as a string
+     * @return std::string the moves, one of "UDLR" each
+    */
+    std::string str() const;
+};
+#endif
@@ -0,0 +1,191 @@
+#include "optimizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "sokoban.hpp"
+
+Optimizer::Optimizer(const std::vector<std::string> &level)
+    : level(level), maze(level) {
+}
+
+std::string Optimizer::replay(const std::string &solution) const {
+    Sokoban soko({level});
+    Maze::State position = maze.position(level);
+    std::string lurd;
+
+    for (const char c : solution) {
+        const char *found = std::strchr(Maze::pushes, std::toupper(c));
+
+        if (c == '\0' || !found) {
+            return "";
+        }
+
+        const char move = maze.step(position, found - Maze::pushes);
+
+        if (!move || !soko.move((Sokoban::Direction) *found)) {
+            return "";
+        }
+
+        lurd.push_back(move);
+    }
+
+    return soko.solved() ? lurd : "";
+}
+
+std::string Optimizer::compress(const std::string &solution) const {
+    Maze::State position = maze.position(level);
+    std::vector<Maze::Push> line;
+
+    for (const char c : solution) {
+        const unsigned int direction =
+            std::strchr(Maze::pushes, std::toupper(c)) - Maze::pushes;
+        const unsigned short player = position.player;
+
+        if (std::isupper(maze.step(position, direction))) {
+            line.push_back({(unsigned short) (player + maze.offset(direction)),
+                (unsigned char) direction});
+        }
+    }
+
+    return maze.moves(maze.start(), maze.initial().boxes, line);
+}
+
+std::string Optimizer::shortcut(
+    const std::string &solution,
+    const Options &options
+) const {
+    std::vector<Maze::State> line = {maze.position(level)};
+
+    for (const char c : solution) {
+        line.push_back(line.back());
+        maze.step(line.back(),
+            std::strchr(Maze::pushes, std::toupper(c)) - Maze::pushes);
+    }
+
+    // The last time the line passes through each position
+    std::unordered_map<Maze::State, unsigned int, Maze::StateHash> last;
+
+    for (unsigned int i = 0; i < line.size(); i++) {
+        last[line[i]] = i;
+    }
+
+    struct Visit {
+        Maze::State position;
+        unsigned int parent;
+        char move;
+    };
+
+    std::string result;
+
+    for (unsigned int i = 0; i < solution.size();) {
+        std::vector<Visit> visits = {{line[i], 0, 0}};
+        std::unordered_set<Maze::State, Maze::StateHash> seen = {line[i]};
+        unsigned int best = 0;
+        unsigned int best_saving = 0;
+        unsigned int best_target = 0;
+
+        // Breadth-first by layer so each visit's depth is its layer
+        for (unsigned int depth = 0, begin = 0;
+             depth <= options.window && begin < visits.size() &&
+             visits.size() < options.node_limit;
+             depth++) {
+            const unsigned int end = visits.size();
+
+            for (unsigned int v = begin; v < end; v++) {
+                const auto found = last.find(visits[v].position);
+
+                if (found != last.end() &&
+                    found->second > i + depth + best_saving) {
+                    best = v;
+                    best_saving = found->second - i - depth;
+                    best_target = found->second;
+                }
+
+                for (unsigned int direction = 0;
+                     depth < options.window && direction < 4; direction++) {
+                    Maze::State next = visits[v].position;
+                    const char move = maze.step(next, direction);
+
+                    if (move && seen.insert(next).second) {
+                        visits.push_back({std::move(next), v, move});
+                    }
+                }
+            }
+
+            begin = end;
+        }
+
+        if (best_saving == 0) {
+            result.push_back(solution[i]);
+            i++;
+            continue;
+        }
+
+        std::string path;
+
+        for (unsigned int v = best; v != 0; v = visits[v].parent) {
+            path.push_back(visits[v].move);
+        }
+
+        result.append(path.rbegin(), path.rend());
+        i = best_target;
+    }
+
+    return result;
+}
+
+std::string Optimizer::optimize(
+    const std::string &solution,
+    const Options &options
+) const {
+    const std::string original = replay(solution);
+
+    if (original.empty() && !solution.empty()) {
+        return "";
+    }
+
+    const std::string shortened = replay(shortcut(compress(original), options));
+    return shortened.empty() || shortened.size() > original.size() ?
+        original : shortened;
+}
+
+std::vector<std::string> Optimizer::optimize(
+    const std::vector<Job> &jobs,
+    const Options &options,
+    unsigned int threads
+) {
+    std::vector<std::string> results(jobs.size());
+    std::atomic<size_t> next(0);
+    const auto work = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            try {
+                results[i] = Optimizer(jobs[i].level)
+                    .optimize(jobs[i].solution, options);
+            }
+            catch (const std::invalid_argument &) {
+                results[i] = "";
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 1; i < threads; i++) {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    return results;
+}
@@ -0,0 +1,100 @@
+#ifndef __OPTIMIZER_H__
+#define __OPTIMIZER_H__
+
+#include <string>
+#include <vector>
+
+#include "maze.hpp"
+
+/**
+ * Shortens valid solutions. A solution is replayed through the Sokoban
+ * engine, the walks between its pushes are replaced with shortest walks,
+ * and then short windows of the line are searched move by move for
+ * shortcuts between positions it passes through. The result is replayed
+ * again before it is returned, so it is always a valid solution.
+*/
+class Optimizer {
+public:
+    /**
+     * Limits on the local searches
+    */
+    struct Options {
+        /**
+         * Deepest shortcut, in moves, searched from each position
+        */
+        unsigned int window = 12;
+
+        /**
+         * Most positions visited by the search from a single position
+        */
+        unsigned long node_limit = 20000;
+    };
+
+    /**
+     * A level and a solution to shorten
+    */
+    struct Job {
+        std::vector<std::string> level;
+        std::string solution;
+    };
+
+private:
+    std::vector<std::string> level;
+    Maze maze;
+
+    /**
+     * Replay a solution through the engine
+     * @param std::string solution the moves, in either case
+     * @return std::string the solution in LURD notation, or empty if it
+     * is not a valid solution
+    */
+    std::string replay(const std::string &solution) const;
+
+    /**
+     * Replace every walk between pushes with a shortest walk
+     * @param std::string solution a valid LURD solution
+     * @return std::string a solution no longer than the original
+    */
+    std::string compress(const std::string &solution) const;
+
+    /**
+     * Search forward from each position for a shorter way to a later one
+     * @param std::string solution a valid LURD solution
+     * @param Options options the search limits
+     * @return std::string a solution no longer than the original
+    */
+    std::string shortcut(const std::string &solution,
+        const Options &options) const;
+
+public:
+    /**
+     * Constructor which accepts a board in the same format Sokoban uses
+     * @param std::vector<std::string> level the level the solutions solve
+    */
+    Optimizer(const std::vector<std::string> &level);
+
+    /**
+     * Shorten a solution
+     * @param std::string solution a solution of the level
+     * @param Options options the search limits
+     * @return std::string the shortened LURD solution, or empty if the
+     * input doesn't solve the level
+    */
+    std::string optimize(const std::string &solution,
+        const Options &options) const;
+
+    /**
+     * Shorten many solutions, spreading the jobs across threads
+     * @param std::vector<Job> jobs the levels and their solutions
+     * @param Options options the search limits
+     * @param unsigned int threads the number of threads to use
+     * @return std::vector<std::string> the results in job order, empty for
+     * jobs whose solution or level is invalid
+    */
+    static std::vector<std::string> optimize(
+        const std::vector<Job> &jobs,
+        const Options &options,
+        unsigned int threads
+    );
+};
+#endif
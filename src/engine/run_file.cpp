@@ -0,0 +1,70 @@
+#include "run_file.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+RunFile::Writer::Writer(const std::string &path, unsigned int width)
+    : out(path, std::ios::binary), previous(width, 0), _count(0) {
+    if (!out) {
+        throw std::invalid_argument("Cannot open file " + path);
+    }
+}
+
+void RunFile::Writer::write(const unsigned char *record) {
+    const auto mismatch = std::mismatch(
+        previous.begin(), previous.end(), record);
+    const unsigned int shared = mismatch.first - previous.begin();
+
+    // A repeat of the first record (all zero bytes) still needs a marker,
+    // so the shared length is capped one short of the full width
+    const unsigned int prefix = std::min<unsigned int>(
+        shared, previous.size() - 1);
+
+    out.put((char) prefix);
+    out.write((const char *) record + prefix, previous.size() - prefix);
+    std::copy(record, record + previous.size(), previous.begin());
+    _count++;
+}
+
+void RunFile::Writer::close() {
+    out.close();
+
+    if (!out) {
+        throw std::invalid_argument("Cannot write run file");
+    }
+}
+
+unsigned long RunFile::Writer::count() const {
+    return _count;
+}
+
+RunFile::Reader::Reader(const std::string &path, unsigned int width)
+    : in(path, std::ios::binary), current(width, 0) {
+    if (!in) {
+        throw std::invalid_argument("Cannot open file " + path);
+    }
+}
+
+bool RunFile::Reader::next() {
+    const int prefix = in.get();
+
+    if (prefix == std::char_traits<char>::eof()) {
+        return false;
+    }
+
+    in.read((char *) current.data() + prefix, current.size() - prefix);
+
+    if (!in) {
+        throw std::invalid_argument("Truncated run file");
+    }
+
+    return true;
+}
+
+const std::vector<unsigned char> &RunFile::Reader::record() const {
+    return current;
+}
+
+void RunFile::Reader::close() {
+    in.close();
+}
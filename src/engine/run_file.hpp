@@ -0,0 +1,84 @@
+#ifndef __RUN_FILE_H__
+#define __RUN_FILE_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * A sorted run of fixed-width records on disk. Each record is stored as the
+ * length of the prefix it shares with the previous record followed by the
+ * remaining bytes, so runs of nearby states compress well and are only ever
+ * read and written sequentially.
+*/
+class RunFile {
+public:
+    /**
+     * Appends records, which must arrive in sorted order without duplicates
+    */
+    class Writer {
+        std::ofstream out;
+        std::vector<unsigned char> previous;
+        unsigned long _count;
+
+    public:
+        /**
+         * Constructor which creates or truncates the file at path
+         * @param std::string path the file to write
+         * @param unsigned int width the size of every record in bytes
+        */
+        Writer(const std::string &path, unsigned int width);
+
+        /**
+         * Append a record
+         * @param unsigned char *record width bytes to write
+        */
+        void write(const unsigned char *record);
+
+        /**
+         * Flush and close the file
+        */
+        void close();
+
+        /**
+         * Return the number of records written
+         * @return unsigned long the count
+        */
+        unsigned long count() const;
+    };
+
+    /**
+     * Reads records back in order
+    */
+    class Reader {
+        std::ifstream in;
+        std::vector<unsigned char> current;
+
+    public:
+        /**
+         * Constructor which opens the file at path
+         * @param std::string path the file to read
+         * @param unsigned int width the size of every record in bytes
+        */
+        Reader(const std::string &path, unsigned int width);
+
+        /**
+         * Advance to the next record
+         * @return bool true if a record was read, false at the end
+        */
+        bool next();
+
+        /**
+         * Return the record most recently read
+         * @return std::vector<unsigned char> the record bytes
+        */
+        const std::vector<unsigned char> &record() const;
+
+        /**
+         * Close the file, which Windows won't rename or replace while it's
+         * open
+        */
+        void close();
+    };
+};
+#endif
@@ -0,0 +1,36 @@
+#ifndef __SESSION_H__
+#define __SESSION_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hint.hpp"
+#include "level_store.hpp"
+#include "sokoban.hpp"
+
+/**
+ * One game being played through the C API, with the buffers that back the
+ * strings handed back to the caller
+*/
+struct Session {
+    std::shared_ptr<const LevelStore> levels;
+    Sokoban soko;
+    std::string board;
+    std::string sequence;
+    std::string hint_move;
+    std::string state;
+    std::string stats;
+
+    /**
+     * The row, column and symbol of each cell the last batch changed
+    */
+    std::vector<int> changes;
+
+    /**
+     * Created on the first hint request and rebuilt when the level changes
+    */
+    std::unique_ptr<Hint> hint;
+    unsigned int hint_level = 0;
+};
+#endif
@@ -0,0 +1,59 @@
+#include "session_pool.hpp"
+
+#include <stdexcept>
+#include <string>
+
+unsigned int SessionPool::create(std::shared_ptr<const LevelStore> levels) {
+    if (free.empty()) {
+        if (slots.size() >= (1u << index_bits) - 1) {
+            throw std::invalid_argument("Too many sessions");
+        }
+
+        slots.emplace_back();
+        free.push_back(slots.size() - 1);
+    }
+
+    const unsigned int index = free.back();
+    Slot &slot = slots[index];
+    slot.session.emplace(Session{levels, Sokoban(levels)});
+    free.pop_back();
+
+    // Slot indices are offset by one so that 0 is never a handle
+    return slot.generation << index_bits | (index + 1);
+}
+
+void SessionPool::destroy(unsigned int handle) {
+    at(handle);
+    const unsigned int index = (handle & ((1u << index_bits) - 1)) - 1;
+    Slot &slot = slots[index];
+    slot.session.reset();
+    slot.generation = (slot.generation + 1) % (1u << (31 - index_bits));
+    free.push_back(index);
+}
+
+Session &SessionPool::at(unsigned int handle) {
+    Session *session = find(handle);
+
+    if (!session) {
+        throw std::invalid_argument(
+            "No session with handle " + std::to_string(handle)
+        );
+    }
+
+    return *session;
+}
+
+Session *SessionPool::find(unsigned int handle) {
+    const unsigned int index = (handle & ((1u << index_bits) - 1)) - 1;
+
+    if (index >= slots.size() || !slots[index].session ||
+        slots[index].generation != handle >> index_bits) {
+        return nullptr;
+    }
+
+    return &*slots[index].session;
+}
+
+unsigned int SessionPool::size() const {
+    return slots.size() - free.size();
+}
@@ -0,0 +1,73 @@
+#ifndef __SESSION_POOL_H__
+#define __SESSION_POOL_H__
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "level_store.hpp"
+#include "session.hpp"
+
+/**
+ * Owns the sessions of a process and hands out integer handles to them.
+ * Sessions live in slots that are allocated in blocks and reused after a
+ * session is destroyed, so creating one allocates nothing beyond the game's
+ * own board. A handle carries its slot's generation, so a handle kept after
+ * its session is destroyed is rejected rather than reaching a newer session.
+*/
+class SessionPool {
+    struct Slot {
+        std::optional<Session> session;
+        unsigned int generation = 0;
+    };
+
+    /**
+     * A deque never moves its elements, so sessions keep their addresses
+     * as the pool grows
+    */
+    std::deque<Slot> slots;
+    std::vector<unsigned int> free;
+
+public:
+    /**
+     * Bits of a handle that hold the slot index; the generation sits above
+     * them, and handles stay positive as 32-bit signed integers
+    */
+    static const unsigned int index_bits = 20;
+
+    /**
+     * Start a session on the first level of a store
+     * @param std::shared_ptr<const LevelStore> levels the shared levels
+     * @return unsigned int the session's handle, never 0
+    */
+    unsigned int create(std::shared_ptr<const LevelStore> levels);
+
+    /**
+     * End a session and free its slot for reuse
+     * @param unsigned int handle the session's handle
+    */
+    void destroy(unsigned int handle);
+
+    /**
+     * Look up a live session
+     * @param unsigned int handle the session's handle
+     * @return Session the session
+    */
+    Session &at(unsigned int handle);
+
+    /**
+     * Look up a session without throwing, for callers such as the C API
+     * that can't let an exception escape
+     * @param unsigned int handle the session's handle
+     * @return Session * the session, or nullptr if the handle is stale or
+     * was never issued
+    */
+    Session *find(unsigned int handle);
+
+    /**
+     * @return unsigned int the number of live sessions
+    */
+    unsigned int size() const;
+};
+#endif
@@ -1,13 +1,80 @@
 #include "sokoban.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <queue>
 #include <stack>
 #include <stdexcept>
+#include <string_view>
 #include <unordered_map>
 
-Sokoban::Sokoban(std::vector<std::vector<std::string>> levels) {
-    this->levels = levels;
+#include "trace.hpp"
+
+namespace {
+
+constexpr std::string_view serial_magic = "SOKS";
+
+/**
+ * Append the low bytes of a value in little-endian order
+*/
+void put(std::string &out, unsigned int value, unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; i++) {
+        out.push_back((char) (value >> (8 * i)));
+    }
+}
+
+/**
+ * Read a little-endian value, moving the offset past it
+*/
+unsigned int get(const std::string &in, size_t &offset, unsigned int bytes) {
+    if (offset + bytes > in.size()) {
+        throw std::invalid_argument("Truncated saved game");
+    }
+
+    unsigned int value = 0;
+
+    for (unsigned int i = 0; i < bytes; i++) {
+        value |= (unsigned int) (unsigned char) in[offset++] << (8 * i);
+    }
+
+    return value;
+}
+
+/**
+ * Read a packed field of bits, bits_each wide, at an index
+*/
+unsigned int bits(const std::string &in, size_t offset, unsigned int index,
+                  unsigned int bits_each) {
+    const unsigned int bit = index * bits_each;
+    return (unsigned char) in[offset + bit / 8] >> (bit % 8) &
+        ((1u << bits_each) - 1);
+}
+
+/**
+ * Set a packed field of bits, bits_each wide, at an index
+*/
+void set_bits(std::string &out, unsigned int index, unsigned int bits_each,
+              unsigned int value) {
+    const unsigned int bit = index * bits_each;
+    out[bit / 8] |= (char) (value << (bit % 8));
+}
+
+}
+
+const std::unordered_map<Sokoban::Direction, std::pair<int, int>>
+    Sokoban::dir_offsets {
+    {L, std::make_pair(0, -1)},
+    {R, std::make_pair(0, 1)},
+    {U, std::make_pair(-1, 0)},
+    {D, std::make_pair(1, 0)}
+};
+
+Sokoban::Sokoban(std::vector<std::vector<std::string>> levels)
+    : Sokoban(std::make_shared<const LevelStore>(std::move(levels))) {
+}
+
+Sokoban::Sokoban(std::shared_ptr<const LevelStore> levels)
+    : levels(std::move(levels)) {
     change_level(0);
 }
 
@@ -37,14 +104,14 @@ std::vector<std::string> Sokoban::board() {
     return _board;
 }
 
-void Sokoban::locate_player() {
-    for (unsigned int y = 0; y < _board.size(); y++) {
-        for (unsigned int x = 0; x < _board[y].size(); x++) {
-            if (_board[y][x] == Cell::PLAYER ||
-                _board[y][x] == Cell::PLAYER_ON_GOAL) {
-                px = x;
-                py = y;
-                return;
+std::pair<unsigned int, unsigned int> Sokoban::locate_player(
+    const std::vector<std::string> &board
+) {
+    for (unsigned int y = 0; y < board.size(); y++) {
+        for (unsigned int x = 0; x < board[y].size(); x++) {
+            if (board[y][x] == Cell::PLAYER ||
+                board[y][x] == Cell::PLAYER_ON_GOAL) {
+                return {y, x};
             }
         }
     }
@@ -73,21 +140,50 @@ void Sokoban::push_box(int dy, int dx) {
         Cell::BOX_ON_GOAL : Cell::BOX;
 }
 
-/* Update move with associated board state */
-void Sokoban::update(Direction direction) {
-    moves.push_back(direction);
-    history.push_back(std::make_pair(_board, true));
+void Sokoban::pull_box(int dy, int dx) {
+    // Set the cell state when box leaves the cell beyond the adjacent one
+    _board[py+dy+dy][px+dx+dx] =
+        (_board[py+dy+dy][px+dx+dx] == Cell::BOX_ON_GOAL) ?
+        Cell::GOAL : Cell::EMPTY;
+
+    // Set the cell state when box arrives to the adjacent cell
+    _board[py+dy][px+dx] = (_board[py+dy][px+dx] == Cell::GOAL) ?
+        Cell::BOX_ON_GOAL : Cell::BOX;
+}
+
+/* Record a move in the tree, reusing the node if it was made before */
+void Sokoban::update(Direction direction, bool push) {
+    const unsigned int from = current_node;
+    current_node = tree.child(from, {(char) direction, push, true});
+    tree[from].redo = current_node;
+    history.push_back(tree[current_node].step);
+
+    if constexpr (instrumented) {
+        counters.moves++;
+        counters.pushes += push;
+    }
+}
+
+void Sokoban::mark(bool fast_forward) {
+    history.mark_back(fast_forward);
+    tree[current_node].step.fast_forward = fast_forward;
 }
 
 bool Sokoban::make_move(Direction direction) {
-    auto [dy, dx] = dir_offsets[direction];
+    const auto offset = dir_offsets.find(direction);
+
+    if (offset == dir_offsets.end()) {
+        return false;
+    }
+
+    auto [dy, dx] = offset->second;
 
     // Player moves to a goal or empty cell
     if (_board[py+dy][px+dx] == Cell::GOAL || 
         _board[py+dy][px+dx] == Cell::EMPTY) {
 
         move_player(dy, dx);
-        update(direction);
+        update(direction, false);
 
         return true;
     }
@@ -103,7 +199,7 @@ bool Sokoban::make_move(Direction direction) {
 
             push_box(dy, dx);
             move_player(dy, dx);
-            update(direction);
+            update(direction, true);
 
             return true;
         }
@@ -112,11 +208,73 @@ bool Sokoban::make_move(Direction direction) {
 }
 
 bool Sokoban::move(Direction direction) {
-    undone.clear();
-    return make_move(direction);
+    if (!make_move(direction)) {
+        return false;
+    }
+
+    // A fresh move starts a line of its own, with nothing to redo
+    mark(true);
+    tree[current_node].redo = 0;
+    return true;
+}
+
+std::vector<Sokoban::Change>
+Sokoban::move_batch(const std::string &directions) {
+    for (const char c : directions) {
+        if (!dir_offsets.count((Direction) c)) {
+            throw std::invalid_argument("Invalid direction");
+        }
+    }
+
+    // The cells the moves may touch, with their contents before the batch
+    std::vector<Change> touched;
+
+    if (solved()) {
+        return touched;
+    }
+
+    auto touch = [&](unsigned int y, unsigned int x) {
+        for (const Change &change : touched) {
+            if (change.y == y && change.x == x) {
+                return;
+            }
+        }
+
+        touched.push_back({y, x, _board[y][x]});
+    };
+
+    for (const char c : directions) {
+        auto [dy, dx] = dir_offsets.at((Direction) c);
+        const char next = _board[py+dy][px+dx];
+        touch(py, px);
+        touch(py + dy, px + dx);
+
+        if (next == Cell::BOX || next == Cell::BOX_ON_GOAL) {
+            touch(py + dy + dy, px + dx + dx);
+        }
+
+        // Only a push can cover the last goal
+        if (move((Direction) c) && history.back().push && solved()) {
+            break;
+        }
+    }
+
+    // A cell can end as it began, as after moving back and forth
+    std::vector<Change> changes;
+
+    for (const Change &change : touched) {
+        const char cell = _board[change.y][change.x];
+
+        if (cell != change.cell) {
+            changes.push_back({change.y, change.x, cell});
+        }
+    }
+
+    return changes;
 }
 
 bool Sokoban::move(unsigned int y, unsigned int x) {
+    Trace::Scope trace("walk", "engine");
 
     auto origin = std::make_pair(py, px);
     auto destination = std::make_pair(y, x);
@@ -141,6 +299,10 @@ bool Sokoban::move(unsigned int y, unsigned int x) {
         auto current = queue.front();
         queue.pop();
 
+        if constexpr (instrumented) {
+            counters.walk_nodes++;
+        }
+
         if (current == destination) {
             // Mark the origin with fast-forward
             //history.back().second = true;
@@ -162,11 +324,11 @@ bool Sokoban::move(unsigned int y, unsigned int x) {
                     if (offset == dir_offsets.at(direction)) {
                         move(direction);
                         // Unmark fast-forward
-                        history.back().second = false;
+                        mark(false);
 
                         // Mark the destination with fast-forward
                         if (paths.size() == 1) {
-                            history.back().second = true;
+                            mark(true);
                         }
                     }
                 }
@@ -209,33 +371,78 @@ bool Sokoban::move(unsigned int y, unsigned int x) {
 }
 
 bool Sokoban::undo() {
-    if (moves.empty()) {
+    if (current_node == UndoTree::root) {
         return false;
     }
 
-    undone.push_back(std::make_pair(moves.back(), _board));
+    const UndoTree::Node &node = tree[current_node];
+    auto [dy, dx] = dir_offsets.at((Direction) node.step.direction);
+
+    // Walk the player back, then pull the box it pushed after it
+    move_player(-dy, -dx);
+
+    if (node.step.push) {
+        pull_box(dy, dx);
+    }
 
-    moves.pop_back();
+    tree[node.parent].redo = current_node;
+    current_node = node.parent;
     history.pop_back();
 
-    _board = history.back().first;
-    locate_player();
+    if constexpr (instrumented) {
+        counters.undos++;
+    }
 
     return true;
 }
 
 bool Sokoban::redo() {
-    if (undone.empty()) {
+    const unsigned int next = tree[current_node].redo;
+
+    if (!next || !make_move((Direction) tree[next].step.direction)) {
+        return false;
+    }
+
+    if constexpr (instrumented) {
+        counters.redos++;
+    }
+
+    return true;
+}
+
+unsigned int Sokoban::node() const {
+    return current_node;
+}
+
+unsigned int Sokoban::parent(unsigned int node) const {
+    return node < tree.size() ? tree[node].parent : UndoTree::root;
+}
+
+std::vector<unsigned int> Sokoban::variations(unsigned int node) const {
+    return node < tree.size() ?
+        tree.children(node) : std::vector<unsigned int>();
+}
+
+bool Sokoban::jump(unsigned int node) {
+    if (node >= tree.size()) {
         return false;
     }
 
-    Direction direction = undone.back().first;
-    _board = undone.back().second;
-    update(direction);
+    const unsigned int meet = tree.common_ancestor(current_node, node);
+    std::vector<unsigned int> down;
 
-    undone.pop_back();
+    for (unsigned int n = node; n != meet; n = tree[n].parent) {
+        down.push_back(n);
+    }
 
-    locate_player();
+    while (current_node != meet) {
+        undo();
+    }
+
+    // Every move on the way down was legal when its node was added
+    for (auto n = down.rbegin(); n != down.rend(); n++) {
+        make_move((Direction) tree[*n].step.direction);
+    }
 
     return true;
 }
@@ -245,41 +452,229 @@ void Sokoban::reset() {
 }
 
 void Sokoban::change_level(unsigned int level_number) {
+    Trace::Scope trace("load level", "engine");
+    trace.arg("level", level_number);
+
+    // Check the board first so a bad level number, a level not fetched
+    // yet or a board without a player changes nothing
+    std::vector<std::string> board = *levels->board(level_number);
+    const auto [y, x] = locate_player(board);
+    _board = std::move(board);
+    py = y;
+    px = x;
     current_level = level_number;
-    _board = levels.at(current_level);
-    moves.clear();
-    undone.clear();
-    history.push_back(std::make_pair(_board, false));
-    locate_player();
+    history.clear();
+    tree.clear();
+    current_node = UndoTree::root;
 }
 
 bool Sokoban::rewind() {
-    if (moves.empty()) {
+    if (!undo()) {
         return false;
     }
 
-    undo();
+    // Keep going until the end of the previous operation
+    while (!history.empty() && !history.back().fast_forward) {
+        undo();
+    }
 
-    while (!moves.empty()) {
-        bool fast_forward = history.back().second;
+    return true;
+}
 
-        if (!fast_forward) {
-            undo();
-        }
-        else {
-            // Unmark the fast-forward
-            history.back().second = false;
-            break;
+std::string Sokoban::sequence() {
+    return history.str();
+}
+
+unsigned int Sokoban::moves() const {
+    return history.size();
+}
+
+unsigned int Sokoban::pushes() const {
+    return history.pushes();
+}
+
+Sokoban::Stats Sokoban::stats() const {
+    Stats stats = counters;
+
+    if constexpr (instrumented) {
+        stats.history_bytes = history.bytes() + tree.bytes();
+    }
+
+    return stats;
+}
+
+std::string Sokoban::serialize() const {
+    std::string blob(serial_magic);
+    put(blob, serial_version, 1);
+    put(blob, current_level, 4);
+    put(blob, py, 2);
+    put(blob, px, 2);
+    std::string boxes;
+    unsigned int cells = 0;
+
+    for (const std::string &row : _board) {
+        for (const char cell : row) {
+            if (cells % 8 == 0) {
+                boxes.push_back('\0');
+            }
+
+            set_bits(boxes, cells++, 1,
+                cell == Cell::BOX || cell == Cell::BOX_ON_GOAL);
         }
     }
 
-    return true;
+    put(blob, cells, 4);
+    blob += boxes;
+
+    const unsigned int count = history.size();
+    std::string move_bits((count * 2 + 7) / 8, '\0');
+    std::string push_bits((count + 7) / 8, '\0');
+    std::string fast_forward_bits((count + 7) / 8, '\0');
+
+    for (unsigned int i = 0; i < count; i++) {
+        const MoveSequence::Step step = history[i];
+        set_bits(move_bits, i, 2, std::strchr(MoveSequence::codes,
+            step.direction) - MoveSequence::codes);
+        set_bits(push_bits, i, 1, step.push);
+        set_bits(fast_forward_bits, i, 1, step.fast_forward);
+    }
+
+    put(blob, count, 4);
+    return blob + move_bits + push_bits + fast_forward_bits;
 }
 
-std::string Sokoban::sequence() {
-    std::string sequence = "";
-    for (const auto& direction : moves) {
-        sequence.push_back((char) direction);
+void Sokoban::deserialize(const std::string &blob) {
+    size_t offset = serial_magic.size();
+
+    if (blob.compare(0, offset, serial_magic) ||
+        get(blob, offset, 1) != serial_version) {
+        throw std::invalid_argument("Not a saved game of version " +
+            std::to_string(serial_version));
+    }
+
+    const unsigned int level = get(blob, offset, 4);
+    const unsigned int y = get(blob, offset, 2);
+    const unsigned int x = get(blob, offset, 2);
+    const unsigned int cells = get(blob, offset, 4);
+    std::vector<std::string> board = *levels->board(level);
+    unsigned int cell = 0;
+    int box_balance = 0;
+
+    if (offset + (cells + 7) / 8 > blob.size()) {
+        throw std::invalid_argument("Truncated saved game");
+    }
+
+    // Lift the boxes and player off the level, then set down the saved ones
+    for (std::string &row : board) {
+        for (char &c : row) {
+            const bool box = cell < cells && bits(blob, offset, cell, 1);
+            box_balance += (c == Cell::BOX || c == Cell::BOX_ON_GOAL) - box;
+            const bool goal = c == Cell::GOAL || c == Cell::BOX_ON_GOAL ||
+                c == Cell::PLAYER_ON_GOAL;
+
+            if (box && c == Cell::WALL) {
+                throw std::invalid_argument("Saved box inside a wall");
+            }
+            else if (c != Cell::WALL) {
+                if (box) {
+                    c = goal ? Cell::BOX_ON_GOAL : Cell::BOX;
+                }
+                else {
+                    c = goal ? Cell::GOAL : Cell::EMPTY;
+                }
+            }
+
+            cell++;
+        }
     }
-    return sequence;
+
+    if (cell != cells || box_balance != 0) {
+        throw std::invalid_argument("Saved game doesn't fit its level");
+    }
+    else if (y >= board.size() || x >= board[y].size() ||
+             (board[y][x] != Cell::EMPTY && board[y][x] != Cell::GOAL)) {
+        throw std::invalid_argument("Saved player isn't on a free cell");
+    }
+
+    board[y][x] = board[y][x] == Cell::GOAL ?
+        Cell::PLAYER_ON_GOAL : Cell::PLAYER;
+    offset += (cells + 7) / 8;
+    const unsigned int count = get(blob, offset, 4);
+    const size_t move_bits = offset;
+    const size_t push_bits = move_bits + (count * 2 + 7) / 8;
+    const size_t fast_forward_bits = push_bits + (count + 7) / 8;
+
+    if (fast_forward_bits + (count + 7) / 8 != blob.size()) {
+        throw std::invalid_argument("Saved game has the wrong length");
+    }
+
+    MoveSequence steps;
+    UndoTree line;
+    unsigned int node = UndoTree::root;
+
+    for (unsigned int i = 0; i < count; i++) {
+        steps.push_back({
+            MoveSequence::codes[bits(blob, move_bits, i, 2)],
+            (bool) bits(blob, push_bits, i, 1),
+            (bool) bits(blob, fast_forward_bits, i, 1),
+        });
+        node = line.child(node, steps.back());
+    }
+
+    // Undo and jump trust every step to be a legal move, so take the
+    // steps back on a copy and require them to lead from the level's start
+    std::vector<std::string> scratch = board;
+    int sy = y;
+    int sx = x;
+    auto vacant = [&](int cy, int cx) {
+        return cy >= 0 && cy < (int) scratch.size() && cx >= 0 &&
+            cx < (int) scratch[cy].size() &&
+            (scratch[cy][cx] == Cell::EMPTY || scratch[cy][cx] == Cell::GOAL);
+    };
+    auto box = [&](int cy, int cx) {
+        return cy >= 0 && cy < (int) scratch.size() && cx >= 0 &&
+            cx < (int) scratch[cy].size() &&
+            (scratch[cy][cx] == Cell::BOX ||
+             scratch[cy][cx] == Cell::BOX_ON_GOAL);
+    };
+    auto lift = [&](int cy, int cx) {
+        char &c = scratch[cy][cx];
+        const bool goal = c == Cell::BOX_ON_GOAL || c == Cell::PLAYER_ON_GOAL;
+        c = goal ? Cell::GOAL : Cell::EMPTY;
+    };
+
+    for (unsigned int i = count; i-- > 0;) {
+        const MoveSequence::Step step = steps[i];
+        const auto [dy, dx] = dir_offsets.at((Direction) step.direction);
+
+        if (!vacant(sy - dy, sx - dx) ||
+                (step.push && !box(sy + dy, sx + dx))) {
+            throw std::invalid_argument("Saved moves don't fit the board");
+        }
+
+        lift(sy, sx);
+
+        if (step.push) {
+            lift(sy + dy, sx + dx);
+            scratch[sy][sx] = scratch[sy][sx] == Cell::GOAL ?
+                Cell::BOX_ON_GOAL : Cell::BOX;
+        }
+
+        sy -= dy;
+        sx -= dx;
+        scratch[sy][sx] = scratch[sy][sx] == Cell::GOAL ?
+            Cell::PLAYER_ON_GOAL : Cell::PLAYER;
+    }
+
+    if (scratch != *levels->board(level)) {
+        throw std::invalid_argument("Saved moves don't start the level");
+    }
+
+    _board = std::move(board);
+    current_level = level;
+    py = y;
+    px = x;
+    history = std::move(steps);
+    tree = std::move(line);
+    current_node = node;
 }
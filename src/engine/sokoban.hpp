@@ -1,11 +1,17 @@
 #ifndef __SOKOBAN_H__
 #define __SOKOBAN_H__
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "instrumentation.hpp"
+#include "level_store.hpp"
+#include "move_sequence.hpp"
+#include "undo_tree.hpp"
+
 /**
  * A Sokoban game state, containing a vector of levels, a current level, and methods 
  * to operate on the level and retrieve information about its state
@@ -22,6 +28,45 @@ public:
         R = 'R'
     };
 
+    /**
+     * A cell a batch of moves changed, with its new contents
+    */
+    struct Change {
+        unsigned int y;
+        unsigned int x;
+        char cell;
+    };
+
+    /**
+     * Counts of the work done since the game was created, kept only in
+     * builds with instrumentation; see instrumented
+    */
+    struct Stats {
+        /**
+         * Steps the player took forward, including the steps of walks,
+         * redos and jumps, and how many of them pushed a box
+        */
+        unsigned long moves = 0;
+        unsigned long pushes = 0;
+
+        /**
+         * Single steps undone and redone, including the steps of rewinds
+         * and jumps
+        */
+        unsigned long undos = 0;
+        unsigned long redos = 0;
+
+        /**
+         * Cells move(y, x) dequeued searching for paths
+        */
+        unsigned long walk_nodes = 0;
+
+        /**
+         * Heap bytes the current level's history and undo tree hold
+        */
+        unsigned long history_bytes = 0;
+    };
+
 private:
     /**
      * Hashing for pairs which packs the two unsigned ints into a single unique number
@@ -57,19 +102,16 @@ private:
     };
 
     /**
-     * Converts Directions to a pair of y, x delta coordinates for a movement
+     * Converts Directions to a pair of y, x delta coordinates for a movement.
+     * Shared by every instance, so creating a game allocates no map.
     */
-    std::unordered_map<Direction, std::pair<int, int>> dir_offsets {
-        {L, std::make_pair(0, -1)},
-        {R, std::make_pair(0, 1)},
-        {U, std::make_pair(-1, 0)},
-        {D, std::make_pair(1, 0)}
-    };
+    static const std::unordered_map<Direction, std::pair<int, int>>
+        dir_offsets;
 
     /**
-     * A vector of all of the levels this Sokoban instance was constructed with
+     * The levels this Sokoban instance plays, possibly shared with others
     */
-    std::vector<std::vector<std::string>> levels;
+    std::shared_ptr<const LevelStore> levels;
 
     /**
      * The current active board
@@ -88,24 +130,32 @@ private:
     unsigned int px;
 
     /**
-     * The vector of all the moves performed on the current _board so far
+     * The moves from the level's start to the current position, for
+     * rewind, the sequence and its counts
     */
-    std::vector<Direction> moves;
+    MoveSequence history;
 
     /**
-     * The history of all moves for undo/redo purposes
+     * Every line explored on the current level, and the node of the
+     * current position in it
     */
-    std::vector<std::pair<std::vector<std::string>, bool>> history;
+    UndoTree tree;
+    unsigned int current_node;
 
     /**
-     * A redo buffer
+     * The counters stats() returns; left at zero without instrumentation
     */
-    std::vector<std::pair<Direction, std::vector<std::string>>> undone;
+    Stats counters;
 
     /**
-     * Locates the player ('@' or '+') on the board, setting the py and px instance values
+     * Locates the player ('@' or '+') on a board
+     * @param std::vector<std::string> board the board to search
+     * @return std::pair<unsigned int, unsigned int> the player's row and
+     * column
     */
-    void locate_player();
+    static std::pair<unsigned int, unsigned int> locate_player(
+        const std::vector<std::string> &board
+    );
 
     /**
      * Moves the player by dy, dx on the current board, where dy and dx are dir_offsets
@@ -121,11 +171,27 @@ private:
     */
     void push_box(int dy, int dx);
 
+    /**
+     * Pulls the box two cells away by dy, dx back to the adjacent cell,
+     * taking back a push
+     * @param int dy the directional offset on the row axis
+     * @param int dx the directional offset on the column axis
+    */
+    void pull_box(int dy, int dx);
+
     /**
      * Updates metadata such as history associated with a move
      * @param Direction direction the move just made
+     * @param bool push whether the move pushed a box
     */
-    void update(Direction direction);
+    void update(Direction direction, bool push);
+
+    /**
+     * Set whether the last move ends a fast-forward, in the history and
+     * in the tree
+     * @param bool fast_forward the new mark
+    */
+    void mark(bool fast_forward);
 
     /**
      * Attempts to make a move
@@ -140,6 +206,13 @@ public:
     */
     Sokoban(std::vector<std::vector<std::string>> levels);
 
+    /**
+     * Constructor which plays levels from a store, decoding each one only
+     * when it's first played
+     * @param std::shared_ptr<const LevelStore> levels the shared levels
+    */
+    Sokoban(std::shared_ptr<const LevelStore> levels);
+
     /**
      * Return the current level number being played
      * unsigned int level the level number
@@ -179,6 +252,17 @@ public:
     */
     bool move(unsigned int y, unsigned int x);
 
+    /**
+     * Make queued moves in one call, as when input arrives faster than the
+     * board is drawn. Each is a move() of its own, so each is undone on
+     * its own. Blocked moves are skipped, and no moves are made once the
+     * level is solved.
+     * @param std::string directions the moves, one Direction each
+     * @return std::vector<Change> every cell whose contents differ from
+     * before the batch, each once
+    */
+    std::vector<Change> move_batch(const std::string &directions);
+
     /**
      * Undo the last move, if possible
      * @return bool true if the undo modified the board, false otherwise
@@ -186,11 +270,45 @@ public:
     bool undo();  
 
     /**
-     * Redo the last undo action, if possible
+     * Redo the last undo action, if possible. A move made since then
+     * starts a new line that has nothing to redo, though the undone line
+     * stays in the tree for jump().
      * @return bool true if the redo modified the board, false otherwise
     */
     bool redo();
 
+    /**
+     * Return the node of the current position in the tree of every line
+     * explored on the level. The start of the level is node 0, and a
+     * node keeps its number until the level changes.
+     * @return unsigned int the current node
+    */
+    unsigned int node() const;
+
+    /**
+     * Return the node a node's move was made from
+     * @param unsigned int node a node in the tree
+     * @return unsigned int the parent, or 0 for the root
+    */
+    unsigned int parent(unsigned int node) const;
+
+    /**
+     * Return the moves that have been made from a node, each starting a
+     * variation
+     * @param unsigned int node a node in the tree
+     * @return std::vector<unsigned int> the children, oldest first
+    */
+    std::vector<unsigned int> variations(unsigned int node) const;
+
+    /**
+     * Go to any explored position by undoing back to the common ancestor
+     * and replaying down the other line, so the cost is the number of
+     * moves between the two positions rather than a replay from the start
+     * @param unsigned int node the node to go to
+     * @return bool true if the node exists, false otherwise
+    */
+    bool jump(unsigned int node);
+
     /**
      * Reset the current level to its original state
     */
@@ -210,6 +328,47 @@ public:
     */
     std::string sequence();
 
+    /**
+     * Return the number of moves made so far on the level, without
+     * building the sequence
+     * @return unsigned int the number of moves
+    */
+    unsigned int moves() const;
+
+    /**
+     * Return the number of moves so far on the level that pushed a box
+     * @return unsigned int the number of pushes
+    */
+    unsigned int pushes() const;
+
+    /**
+     * Return the counters kept in builds with instrumentation
+     * @return Stats the counts so far, all zero in other builds
+    */
+    Stats stats() const;
+
+    /**
+     * The version of the format written by serialize()
+    */
+    static const unsigned int serial_version = 1;
+
+    /**
+     * Save the game in progress as a small binary blob: the level number,
+     * the player's position, a bitset of the cells holding boxes and the
+     * move history packed into 2 bits per direction plus push and
+     * fast-forward bits. Only the line to the current position is saved,
+     * not the other variations in the tree.
+     * @return std::string the blob
+    */
+    std::string serialize() const;
+
+    /**
+     * Restore a game saved by serialize(), including its undo history,
+     * without replaying it. Nothing changes if the blob is rejected.
+     * @param std::string blob the saved game
+    */
+    void deserialize(const std::string &blob);
+
     /**
      * Prints the current board state to stdout
     */
@@ -0,0 +1,605 @@
+#include "solver.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+
+#include "trace.hpp"
+
+namespace {
+
+const std::string checkpoint_magic = "SOKC";
+const unsigned int checkpoint_version = 1;
+
+/**
+ * Write the low bytes of a value in little-endian order
+*/
+void put(std::ostream &out, unsigned long long value, unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; i++) {
+        out.put((char) (value >> (8 * i)));
+    }
+}
+
+/**
+ * Read a little-endian value of the given width
+*/
+unsigned long long get(std::istream &in, unsigned int bytes) {
+    unsigned long long value = 0;
+
+    for (unsigned int i = 0; i < bytes; i++) {
+        value |= (unsigned long long) (unsigned char) in.get() << (8 * i);
+    }
+
+    if (!in) {
+        throw std::invalid_argument("Truncated checkpoint");
+    }
+
+    return value;
+}
+
+}
+
+bool Solver::Entry::operator<(const Entry &other) const {
+    return f > other.f || (f == other.f && g < other.g);
+}
+
+size_t Solver::NodeHash::operator() (unsigned int node) const {
+    return Maze::StateHash()((*nodes)[node].state);
+}
+
+bool Solver::NodeEqual::operator() (
+    unsigned int left,
+    unsigned int right
+) const {
+    return (*nodes)[left].state == (*nodes)[right].state;
+}
+
+Solver::Solver(const std::vector<std::string> &board)
+    : maze(board),
+      table(0, NodeHash{&nodes}, NodeEqual{&nodes}),
+      incumbent(none),
+      closest(0),
+      expanded(0),
+      weight(1) {
+    const Maze::State root = maze.initial();
+    nodes.push_back({root, none, 0, maze.heuristic(root), {0, 0}});
+    table.insert(0);
+
+    if (maze.solved(root)) {
+        incumbent = 0;
+    }
+    else if (nodes[0].h != Maze::unreachable) {
+        enqueue(0);
+    }
+}
+
+void Solver::enqueue(unsigned int node) {
+    const Node &entry = nodes[node];
+    open.push({entry.g + weight * entry.h, entry.g, node});
+    bounds[entry.g + entry.h]++;
+}
+
+Solver::Entry Solver::dequeue() {
+    const Entry entry = open.top();
+    open.pop();
+
+    const auto count = bounds.find(entry.g + nodes[entry.node].h);
+
+    if (--count->second == 0) {
+        bounds.erase(count);
+    }
+
+    return entry;
+}
+
+void Solver::reweigh(unsigned int weight) {
+    std::vector<Entry> entries;
+
+    while (!open.empty()) {
+        entries.push_back(open.top());
+        open.pop();
+    }
+
+    this->weight = weight;
+
+    for (Entry &entry : entries) {
+        entry.f = entry.g + weight * nodes[entry.node].h;
+        open.push(entry);
+    }
+}
+
+std::vector<unsigned int> Solver::select(unsigned long limit) {
+    std::vector<unsigned int> batch;
+
+    while (!open.empty() && batch.size() < limit) {
+        const Entry entry = dequeue();
+        const Node &node = nodes[entry.node];
+
+        if (entry.g == node.g &&
+            (incumbent == none || node.g + node.h < nodes[incumbent].g)) {
+            batch.push_back(entry.node);
+        }
+    }
+
+    return batch;
+}
+
+std::vector<std::vector<Maze::Successor>> Solver::generate(
+    const std::vector<unsigned int> &batch,
+    WorkerPool *pool,
+    unsigned long *deadlocks
+) const {
+    std::vector<std::vector<Maze::Successor>> successors(batch.size());
+    const unsigned int threads = pool ? pool->size() : 1;
+
+    // Counted per node so the threads never share a counter
+    std::vector<unsigned int> frozen(deadlocks ? batch.size() : 0);
+    const auto work = [&](unsigned int first) {
+        for (unsigned int i = first; i < batch.size(); i += threads) {
+            successors[i] = maze.successors(nodes[batch[i]].state,
+                deadlocks ? &frozen[i] : nullptr);
+        }
+    };
+
+    if (pool && batch.size() > 1) {
+        pool->run(work);
+    }
+    else {
+        for (unsigned int i = 0; i < threads; i++) {
+            work(i);
+        }
+    }
+
+    for (const unsigned int count : frozen) {
+        *deadlocks += count;
+    }
+
+    return successors;
+}
+
+void Solver::expand(
+    unsigned int node,
+    std::vector<Maze::Successor> &successors
+) {
+    const unsigned int g = nodes[node].g + 1;
+
+    for (Maze::Successor &successor : successors) {
+        nodes.push_back(
+            {std::move(successor.state), node, g, 0, successor.push});
+        unsigned int child = nodes.size() - 1;
+        const auto found = table.find(child);
+
+        if (found != table.end()) {
+            nodes.pop_back();
+            child = *found;
+
+            // Keep only strictly shorter lines to a known state
+            if (g >= nodes[child].g) {
+                continue;
+            }
+
+            nodes[child].g = g;
+            nodes[child].parent = node;
+            nodes[child].push = successor.push;
+        }
+        else {
+            nodes[child].h = maze.heuristic(nodes[child].state);
+            table.insert(child);
+        }
+
+        if (nodes[child].h == 0) {
+            if (incumbent == none || g < nodes[incumbent].g) {
+                incumbent = child;
+            }
+            continue;
+        }
+
+        if (nodes[child].h < nodes[closest].h) {
+            closest = child;
+        }
+
+        enqueue(child);
+    }
+}
+
+unsigned int Solver::bound() const {
+    if (bounds.empty()) {
+        return incumbent == none ? Maze::unreachable : nodes[incumbent].g;
+    }
+
+    const unsigned int lowest = bounds.begin()->first;
+    return incumbent == none ? lowest : std::min(lowest, nodes[incumbent].g);
+}
+
+std::string Solver::line(unsigned int node) const {
+    std::vector<Maze::Push> pushes;
+
+    for (; nodes[node].parent != none; node = nodes[node].parent) {
+        pushes.push_back(nodes[node].push);
+    }
+
+    std::reverse(pushes.begin(), pushes.end());
+    return maze.moves(maze.start(), nodes[0].state.boxes, pushes);
+}
+
+Solver::Result Solver::result(Status status) const {
+    const bool proven = incumbent != none &&
+        (bounds.empty() || bounds.begin()->first >= nodes[incumbent].g);
+    Result result{status, "", proven, 0, expanded, bound()};
+
+    if (incumbent != none) {
+        result.solution = line(incumbent);
+        result.pushes = nodes[incumbent].g;
+    }
+    else if (status != UNSOLVABLE) {
+        result.solution = line(closest);
+        result.pushes = nodes[closest].g;
+    }
+
+    return result;
+}
+
+Solver::Stats Solver::stats() const {
+    return counters;
+}
+
+Solver::Result Solver::solve() {
+    return solve(Options());
+}
+
+Solver::Result Solver::solve(const Options &options) {
+    using clock = std::chrono::steady_clock;
+    const auto deadline = clock::now() + options.time_limit;
+    auto next_checkpoint = clock::now() + options.checkpoint_interval;
+    const unsigned int threads = std::max(1u, options.threads);
+    unsigned long count = 0;
+    unsigned long next_check = 0;
+    unsigned int depth = 0;
+    Trace::Scope trace("solve", "solver");
+
+    // A span per node would swamp the trace, so each iteration span
+    // covers a run of expansions and counts the pushes pruned as deadlocks
+    const bool tracing = instrumented && Trace::recording();
+    const unsigned long iteration_nodes = 1000;
+    std::unique_ptr<Trace::Scope> iteration;
+    unsigned long iteration_start = 0;
+    unsigned long deadlocks = 0;
+    const auto end_iteration = [&]() {
+        if (iteration) {
+            iteration->arg("nodes", count - iteration_start);
+            iteration->arg("deadlocks", deadlocks);
+            iteration.reset();
+        }
+    };
+
+    if (options.weight != weight) {
+        reweigh(options.weight);
+    }
+
+    if (threads == 1) {
+        pool.reset();
+    }
+    else if (!pool || pool->size() != threads) {
+        pool = std::make_unique<WorkerPool>(threads);
+    }
+
+    const auto stop = [&](Status status) {
+        end_iteration();
+        trace.arg("nodes", expanded);
+
+        if (options.progress) {
+            options.progress({expanded, depth, bound()});
+        }
+
+        if (!options.checkpoint.empty() && status != SOLVED &&
+            status != UNSOLVABLE) {
+            save(options.checkpoint);
+        }
+
+        return result(status);
+    };
+
+    // Stop once nothing left on the frontier can beat the incumbent
+    while (!open.empty() && (incumbent == none ||
+           (!options.first && bound() < nodes[incumbent].g))) {
+        if (options.cancelled &&
+            options.cancelled->load(std::memory_order_relaxed)) {
+            return stop(CANCELLED);
+        }
+
+        if (options.node_limit && count >= options.node_limit) {
+            return stop(BUDGET_EXHAUSTED);
+        }
+
+        // Reading the clock costs more than expanding a node, so do it
+        // every few dozen nodes
+        if (count >= next_check) {
+            const auto now = clock::now();
+            next_check = count + 64;
+
+            if (options.time_limit.count() && now >= deadline) {
+                return stop(BUDGET_EXHAUSTED);
+            }
+
+            if (!options.checkpoint.empty() &&
+                options.checkpoint_interval.count() &&
+                now >= next_checkpoint) {
+                save(options.checkpoint);
+                next_checkpoint = now + options.checkpoint_interval;
+            }
+        }
+
+        unsigned long limit = threads == 1 ? 1 : threads * 16;
+
+        if (options.node_limit) {
+            limit = std::min(limit, options.node_limit - count);
+        }
+
+        if (tracing && !iteration) {
+            iteration = std::make_unique<Trace::Scope>("iteration", "solver");
+            iteration_start = count;
+            deadlocks = 0;
+        }
+
+        clock::time_point started;
+
+        if constexpr (instrumented) {
+            started = clock::now();
+        }
+
+        const std::vector<unsigned int> batch = select(limit);
+
+        if constexpr (instrumented) {
+            const auto selected = clock::now();
+            counters.select += selected - started;
+            started = selected;
+        }
+
+        auto successors = generate(batch, pool.get(),
+            tracing ? &deadlocks : nullptr);
+
+        if constexpr (instrumented) {
+            const auto generated = clock::now();
+            counters.generate += generated - started;
+            started = generated;
+        }
+
+        for (unsigned int i = 0; i < batch.size(); i++) {
+            depth = nodes[batch[i]].g;
+            expand(batch[i], successors[i]);
+            expanded++;
+            count++;
+
+            if (options.progress_interval && options.progress &&
+                expanded % options.progress_interval == 0) {
+                options.progress({expanded, depth, bound()});
+            }
+        }
+
+        if constexpr (instrumented) {
+            counters.expand += clock::now() - started;
+        }
+
+        if (iteration && count - iteration_start >= iteration_nodes) {
+            end_iteration();
+        }
+    }
+
+    return stop(incumbent == none ? UNSOLVABLE : SOLVED);
+}
+
+void Solver::save(const std::string &path) const {
+    Trace::Scope trace("checkpoint", "solver");
+    const std::string temporary = path + ".tmp";
+    std::ofstream out(temporary, std::ios::binary);
+
+    if (!out) {
+        throw std::invalid_argument("Cannot open file " + temporary);
+    }
+
+    const unsigned int box_count = nodes[0].state.boxes.size();
+    out << checkpoint_magic;
+    put(out, checkpoint_version, 4);
+    put(out, maze.size(), 4);
+    put(out, box_count, 4);
+    put(out, weight, 4);
+    put(out, expanded, 8);
+    put(out, incumbent, 4);
+    put(out, closest, 4);
+    put(out, nodes.size(), 4);
+
+    for (const Node &node : nodes) {
+        put(out, node.state.player, 2);
+
+        for (const unsigned short box : node.state.boxes) {
+            put(out, box, 2);
+        }
+
+        put(out, node.parent, 4);
+        put(out, node.g, 4);
+        put(out, node.h, 4);
+        put(out, node.push.box, 2);
+        put(out, node.push.direction, 1);
+    }
+
+    // Stale and pruned entries are dropped rather than saved
+    std::priority_queue<Entry> frontier = open;
+    std::vector<Entry> entries;
+
+    for (; !frontier.empty(); frontier.pop()) {
+        const Entry &entry = frontier.top();
+
+        if (entry.g == nodes[entry.node].g) {
+            entries.push_back(entry);
+        }
+    }
+
+    put(out, entries.size(), 4);
+
+    for (const Entry &entry : entries) {
+        put(out, entry.node, 4);
+    }
+
+    out.close();
+
+    if (!out) {
+        throw std::invalid_argument("Cannot write checkpoint " + path);
+    }
+
+    // Renaming over the old checkpoint fails on Windows runtimes that
+    // won't replace a file, so those remove it first; load() reads the
+    // .tmp file if a save stopped in between
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+
+    if (error) {
+        std::filesystem::remove(path, error);
+        std::filesystem::rename(temporary, path, error);
+    }
+
+    if (error) {
+        throw std::invalid_argument("Cannot write checkpoint " + path);
+    }
+}
+
+void Solver::load(const std::string &path) {
+    std::string file = path;
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+
+    // A save that had to remove the old checkpoint before renaming may
+    // have stopped in between, leaving only the new one beside it
+    if (!in) {
+        file = path + ".tmp";
+        in.open(file, std::ios::binary | std::ios::ate);
+    }
+
+    if (!in) {
+        throw std::invalid_argument("Cannot open file " + path);
+    }
+
+    const unsigned long long size = in.tellg();
+    const auto remaining = [&]() {
+        return size - (unsigned long long) in.tellg();
+    };
+    in.seekg(0);
+    std::string magic(checkpoint_magic.size(), ' ');
+    in.read(&magic[0], magic.size());
+
+    if (magic != checkpoint_magic || get(in, 4) != checkpoint_version) {
+        throw std::invalid_argument("Not a checkpoint: " + file);
+    }
+
+    const unsigned int box_count = nodes[0].state.boxes.size();
+
+    if (get(in, 4) != maze.size() || get(in, 4) != box_count) {
+        throw std::invalid_argument("Checkpoint is for another level");
+    }
+
+    // Read into locals so that a bad file leaves the search as it was
+    const unsigned int loaded_weight = get(in, 4);
+    const unsigned long loaded_expanded = get(in, 8);
+    const unsigned int loaded_incumbent = get(in, 4);
+    const unsigned int loaded_closest = get(in, 4);
+    const unsigned long long count = get(in, 4);
+
+    // Counts are checked against the file's size before anything is
+    // allocated for them
+    const unsigned long long record = 2 + 2 * box_count + 4 + 4 + 4 + 2 + 1;
+
+    if (count == 0 || count * record + 4 > remaining()) {
+        throw std::invalid_argument("Corrupt checkpoint " + file);
+    }
+
+    std::vector<Node> loaded(count, {{0, std::vector<unsigned short>(
+        box_count)}, none, 0, 0, {0, 0}});
+
+    for (Node &node : loaded) {
+        node.state.player = get(in, 2);
+
+        for (unsigned short &box : node.state.boxes) {
+            box = get(in, 2);
+        }
+
+        node.parent = get(in, 4);
+        node.g = get(in, 4);
+        node.h = get(in, 4);
+        node.push.box = get(in, 2);
+        node.push.direction = get(in, 1);
+    }
+
+    if (!(loaded[0].state == nodes[0].state)) {
+        throw std::invalid_argument("Checkpoint is for another level");
+    }
+
+    const auto corrupt = [&](unsigned int i) {
+        const Node &node = loaded[i];
+
+        if (node.state.player >= maze.size() || node.push.box >=
+            maze.size() || node.push.direction >= 4) {
+            return true;
+        }
+
+        for (const unsigned short box : node.state.boxes) {
+            if (box >= maze.size()) {
+                return true;
+            }
+        }
+
+        // Lines only ever get shorter towards the root, so a parent with a
+        // g as large as its child's would make line() loop
+        if (i == 0) {
+            return node.parent != none || node.g != 0;
+        }
+
+        return node.parent >= count || loaded[node.parent].g >= node.g;
+    };
+
+    for (unsigned int i = 0; i < count; i++) {
+        if (corrupt(i)) {
+            throw std::invalid_argument("Corrupt checkpoint " + file);
+        }
+    }
+
+    if (loaded_closest >= count ||
+        (loaded_incumbent != none && loaded_incumbent >= count)) {
+        throw std::invalid_argument("Corrupt checkpoint " + file);
+    }
+
+    const unsigned long long entries = get(in, 4);
+
+    if (entries * 4 > remaining()) {
+        throw std::invalid_argument("Corrupt checkpoint " + file);
+    }
+
+    std::vector<unsigned int> frontier(entries);
+
+    for (unsigned int &node : frontier) {
+        node = get(in, 4);
+
+        if (node >= count) {
+            throw std::invalid_argument("Corrupt checkpoint " + file);
+        }
+    }
+
+    weight = loaded_weight;
+    expanded = loaded_expanded;
+    incumbent = loaded_incumbent;
+    closest = loaded_closest;
+    nodes = std::move(loaded);
+    table.clear();
+    table.reserve(nodes.size());
+
+    for (unsigned int i = 0; i < nodes.size(); i++) {
+        table.insert(i);
+    }
+
+    open = {};
+    bounds.clear();
+
+    for (const unsigned int node : frontier) {
+        enqueue(node);
+    }
+}
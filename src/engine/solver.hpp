@@ -0,0 +1,326 @@
+#ifndef __SOLVER_H__
+#define __SOLVER_H__
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "maze.hpp"
+#include "worker_pool.hpp"
+
+/**
+ * An anytime push-optimal Sokoban solver. It runs a weighted A* search over
+ * box configurations that keeps improving its best solution until it is
+ * proven optimal, and stops early on a time or node budget or when
+ * cancelled, returning the best result found so far.
+ *
+ * The search state persists between calls to solve(), so a search that
+ * stopped on a budget continues where it left off when solve() is called
+ * again.
+*/
+class Solver {
+public:
+    /**
+     * Search statistics passed to the progress callback
+    */
+    struct Progress {
+        unsigned long nodes;
+        unsigned int depth;
+        unsigned int bound;
+    };
+
+    /**
+     * Limits and hooks for a call to solve(); zero limits are unlimited
+    */
+    struct Options {
+        std::chrono::milliseconds time_limit{0};
+        unsigned long node_limit = 0;
+
+        /**
+         * Weight on the heuristic; 1 finds an optimal solution first,
+         * larger values find a first solution sooner and then improve it
+        */
+        unsigned int weight = 1;
+
+        /**
+         * Stop at the first solution instead of proving it optimal
+        */
+        bool first = false;
+
+        std::function<void(const Progress &)> progress;
+        unsigned long progress_interval = 10000;
+
+        /**
+         * Polled once per expanded batch, so setting it from another
+         * thread stops the search almost immediately
+        */
+        const std::atomic<bool> *cancelled = nullptr;
+
+        /**
+         * Number of threads generating successors; 1 runs serially
+        */
+        unsigned int threads = 1;
+
+        /**
+         * File the search state is saved to every checkpoint_interval and
+         * whenever the search stops early; empty disables checkpoints
+        */
+        std::string checkpoint;
+        std::chrono::milliseconds checkpoint_interval{0};
+    };
+
+    /**
+     * Why a call to solve() returned
+    */
+    enum Status {
+        SOLVED,
+        UNSOLVABLE,
+        BUDGET_EXHAUSTED,
+        CANCELLED
+    };
+
+    /**
+     * The outcome of a search. solution holds the best LURD line found:
+     * a full solution when one is known (optimal only if proven), otherwise
+     * the line leading to the most promising position reached.
+    */
+    struct Result {
+        Status status;
+        std::string solution;
+        bool optimal;
+        unsigned int pushes;
+        unsigned long nodes;
+        unsigned int bound;
+    };
+
+    /**
+     * Time spent in each phase of the search across every call to
+     * solve(), kept only in builds with instrumentation; see instrumented
+    */
+    struct Stats {
+        /**
+         * Taking the next batch of nodes off the frontier
+        */
+        std::chrono::nanoseconds select{0};
+
+        /**
+         * Generating their successors, on every thread at once
+        */
+        std::chrono::nanoseconds generate{0};
+
+        /**
+         * Looking the successors up in the transposition table, scoring
+         * the new ones and adding them to the frontier
+        */
+        std::chrono::nanoseconds expand{0};
+    };
+
+private:
+    /**
+     * An entry of the search tree, reached from parent by push
+    */
+    struct Node {
+        Maze::State state;
+        unsigned int parent;
+        unsigned int g;
+        unsigned int h;
+        Maze::Push push;
+    };
+
+    /**
+     * An entry of the open list, ordered by weighted cost then depth
+    */
+    struct Entry {
+        unsigned int f;
+        unsigned int g;
+        unsigned int node;
+
+        bool operator<(const Entry &other) const;
+    };
+
+    /**
+     * Hashing and equality for node indices by the state they hold, so the
+     * transposition table doesn't store a second copy of each state
+    */
+    struct NodeHash {
+        const std::vector<Node> *nodes;
+        size_t operator() (unsigned int node) const;
+    };
+
+    struct NodeEqual {
+        const std::vector<Node> *nodes;
+        bool operator() (unsigned int left, unsigned int right) const;
+    };
+
+    static constexpr unsigned int none = ~0u;
+
+    Maze maze;
+
+    /**
+     * Every node ever generated, with the root at index 0
+    */
+    std::vector<Node> nodes;
+
+    /**
+     * The transposition table of node indices
+    */
+    std::unordered_set<unsigned int, NodeHash, NodeEqual> table;
+
+    /**
+     * The frontier, with counts of the admissible costs (g + h) it holds
+     * to report a lower bound on the optimal solution
+    */
+    std::priority_queue<Entry> open;
+    std::map<unsigned int, unsigned long> bounds;
+
+    /**
+     * The best solved node so far and the most promising node by heuristic
+    */
+    unsigned int incumbent;
+    unsigned int closest;
+
+    unsigned long expanded;
+    unsigned int weight;
+
+    /**
+     * The phase times stats() returns; left at zero without
+     * instrumentation
+    */
+    Stats counters;
+
+    /**
+     * The threads generating successors, kept from one solve() to the
+     * next so a search resumed in many short calls starts them once; null
+     * while the search runs serially
+    */
+    std::unique_ptr<WorkerPool> pool;
+
+    /**
+     * Add a node to the frontier
+     * @param unsigned int node the node index
+    */
+    void enqueue(unsigned int node);
+
+    /**
+     * Remove the best entry from the frontier
+     * @return Entry the entry removed
+    */
+    Entry dequeue();
+
+    /**
+     * Rebuild the frontier for a new heuristic weight
+     * @param unsigned int weight the new weight
+    */
+    void reweigh(unsigned int weight);
+
+    /**
+     * Remove up to limit live entries from the frontier, skipping entries
+     * superseded by a shorter line or beaten by the incumbent
+     * @param unsigned long limit the most nodes to select
+     * @return std::vector<unsigned int> the node indices to expand
+    */
+    std::vector<unsigned int> select(unsigned long limit);
+
+    /**
+     * Generate the successors of a batch of nodes, spreading the work
+     * across a pool's threads; the search tree is only read
+     * @param std::vector<unsigned int> batch the node indices to expand
+     * @param WorkerPool * pool the threads to use, or null to run serially
+     * @param unsigned long * deadlocks if given, adds the pushes left out
+     * because they freeze a box
+     * @return std::vector<std::vector<Maze::Successor>> the successors
+     * of each node in batch order
+    */
+    std::vector<std::vector<Maze::Successor>> generate(
+        const std::vector<unsigned int> &batch,
+        WorkerPool *pool,
+        unsigned long *deadlocks = nullptr
+    ) const;
+
+    /**
+     * Add a node's new or improved children to the table and the frontier
+     * @param unsigned int node the node index that was expanded
+     * @param std::vector<Maze::Successor> successors its successors
+    */
+    void expand(unsigned int node, std::vector<Maze::Successor> &successors);
+
+    /**
+     * Return the lowest admissible cost on the frontier
+     * @return unsigned int the lower bound on the optimal push count
+    */
+    unsigned int bound() const;
+
+    /**
+     * Build the LURD line leading from the root to a node
+     * @param unsigned int node the node index
+     * @return std::string the moves and pushes
+    */
+    std::string line(unsigned int node) const;
+
+    /**
+     * Package the current search state as a result
+     * @param Status status why the search stopped
+     * @return Result the result
+    */
+    Result result(Status status) const;
+
+public:
+    /**
+     * Constructor which accepts a board in the same format Sokoban uses
+     * @param std::vector<std::string> board the level to solve
+    */
+    Solver(const std::vector<std::string> &board);
+
+    /**
+     * The transposition table refers back into nodes, so a solver can't be
+     * copied without rebuilding it
+    */
+    Solver(const Solver &) = delete;
+    Solver &operator=(const Solver &) = delete;
+
+    /**
+     * Search until the level is solved optimally, proven unsolvable, a
+     * budget runs out or the search is cancelled
+     * @param Options options the budgets and hooks for this call
+     * @return Result the best result so far
+    */
+    Result solve(const Options &options);
+
+    /**
+     * Write the search tree, frontier and best results to a checkpoint file.
+     * The file is written beside path and renamed over it, so an
+     * interrupted save never clobbers the previous checkpoint. Where the
+     * rename can't replace a file, the old checkpoint is removed first.
+     * @param std::string path the file to write
+    */
+    void save(const std::string &path) const;
+
+    /**
+     * Replace the search state with a checkpoint written by save() for the
+     * same level, so the next solve() resumes from it. A file that isn't
+     * sound is rejected with the search left as it was.
+     * @param std::string path the file to read, or the file save() writes
+     * beside it if a save was interrupted after removing it
+    */
+    void load(const std::string &path);
+
+    /**
+     * Return the phase times kept in builds with instrumentation
+     * @return Stats the times so far, all zero in other builds
+    */
+    Stats stats() const;
+
+    /**
+     * Search with no budgets until the level is solved or proven unsolvable
+     * @return Result the optimal solution, if any
+    */
+    Result solve();
+};
+#endif
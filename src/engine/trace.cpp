@@ -0,0 +1,127 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+std::atomic<bool> Trace::on(false);
+std::mutex Trace::mutex;
+std::vector<Trace::Event> Trace::events;
+std::chrono::steady_clock::time_point Trace::origin;
+size_t Trace::capacity = 0;
+unsigned long Trace::dropped = 0;
+
+namespace {
+
+/**
+ * Number threads in the order they first record, so the viewer shows
+ * small, stable thread ids
+*/
+unsigned int thread_number() {
+    static std::atomic<unsigned int> next(0);
+    thread_local const unsigned int number = next++;
+    return number;
+}
+
+}
+
+Trace::Scope::Scope(const char *name, const char *category) {
+    if constexpr (instrumented) {
+        recording = Trace::recording();
+
+        if (recording) {
+            this->name = name;
+            this->category = category;
+            began = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+void Trace::Scope::arg(const char *key, unsigned long value) {
+    if constexpr (instrumented) {
+        if (recording) {
+            args += std::string(args.empty() ? "" : ", ") + "\"" + key +
+                "\": " + std::to_string(value);
+        }
+    }
+}
+
+Trace::Scope::~Scope() {
+    if constexpr (instrumented) {
+        if (recording) {
+            Trace::record(name, category, began,
+                std::chrono::steady_clock::now(), args);
+        }
+    }
+}
+
+void Trace::record(const char *name, const char *category,
+                   std::chrono::steady_clock::time_point began,
+                   std::chrono::steady_clock::time_point ended,
+                   const std::string &args) {
+    using microseconds = std::chrono::duration<double, std::micro>;
+    const unsigned int thread = thread_number();
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (events.size() >= capacity) {
+        dropped++;
+        return;
+    }
+
+    events.push_back({name, category, microseconds(began - origin).count(),
+        microseconds(ended - began).count(), thread, args});
+}
+
+void Trace::start(size_t capacity) {
+    if constexpr (instrumented) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.clear();
+        events.reserve(std::min<size_t>(capacity, 1 << 16));
+        Trace::capacity = capacity;
+        dropped = 0;
+        origin = std::chrono::steady_clock::now();
+        on = true;
+    }
+}
+
+void Trace::stop() {
+    on = false;
+}
+
+bool Trace::recording() {
+    return on.load(std::memory_order_relaxed);
+}
+
+std::string Trace::json() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    out << std::fixed;
+    out.precision(3);
+    out << "{\"displayTimeUnit\": \"ms\", "
+        << "\"otherData\": {\"dropped\": " << dropped << "}, "
+        << "\"traceEvents\": [\n";
+
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event &event = events[i];
+        out << "  {\"name\": \"" << event.name << "\", "
+            << "\"cat\": \"" << event.category << "\", "
+            << "\"ph\": \"X\", \"ts\": " << event.begin << ", "
+            << "\"dur\": " << event.duration << ", "
+            << "\"pid\": 1, \"tid\": " << event.thread << ", "
+            << "\"args\": {" << event.args << "}}"
+            << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+
+    out << "]}\n";
+    return out.str();
+}
+
+void Trace::write(const std::string &path) {
+    std::ofstream out(path);
+    out << json();
+
+    if (!out) {
+        throw std::invalid_argument("Unable to write " + path);
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "instrumentation.hpp"
+
+/**
+ * Records timed spans of the engine's and the solver's work as Chrome
+ * trace events, for viewing in about:tracing or Perfetto. Spans are
+ * marked with a Scope, which records one complete event from its
+ * construction to its destruction on the thread it ran on.
+ *
+ * Tracing is compiled in only in builds with instrumentation, and even
+ * then records nothing until start() is called. Without instrumentation
+ * a Scope's members go unused and its methods return without reading the
+ * clock or taking a lock.
+*/
+class Trace {
+public:
+    /**
+     * A span of work, recorded when it goes out of scope if tracing was
+     * on when it began
+    */
+    class Scope {
+        const char *name = nullptr;
+        const char *category = nullptr;
+        std::chrono::steady_clock::time_point began;
+        bool recording = false;
+        std::string args;
+
+    public:
+        /**
+         * Begin a span
+         * @param const char * name the span's name, a string literal
+         * @param const char * category the component doing the work
+        */
+        Scope(const char *name, const char *category);
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        /**
+         * Attach a number to the span, shown with it in the viewer
+         * @param const char * key the number's name, a string literal
+         * @param unsigned long value the number
+        */
+        void arg(const char *key, unsigned long value);
+
+        /**
+         * End the span, recording it if tracing was on when it began
+        */
+        ~Scope();
+    };
+
+private:
+    /**
+     * A complete event, with times in microseconds since start()
+    */
+    struct Event {
+        const char *name;
+        const char *category;
+        double begin;
+        double duration;
+        unsigned int thread;
+        std::string args;
+    };
+
+    static std::atomic<bool> on;
+    static std::mutex mutex;
+    static std::vector<Event> events;
+    static std::chrono::steady_clock::time_point origin;
+    static size_t capacity;
+    static unsigned long dropped;
+
+    /**
+     * Add a finished span to the trace, or count it as dropped once the
+     * trace holds its capacity
+    */
+    static void record(const char *name, const char *category,
+        std::chrono::steady_clock::time_point began,
+        std::chrono::steady_clock::time_point ended,
+        const std::string &args);
+
+public:
+    /**
+     * Clear the trace and start recording spans; does nothing in builds
+     * without instrumentation
+     * @param size_t capacity the most events to keep, so a long search
+     * can't exhaust memory
+    */
+    static void start(size_t capacity = 1 << 20);
+
+    /**
+     * Stop recording, keeping the events recorded so far
+    */
+    static void stop();
+
+    /**
+     * @return bool true between start() and stop()
+    */
+    static bool recording();
+
+    /**
+     * Return the events recorded as a Chrome trace-event JSON object,
+     * with one event per line
+     * @return std::string the trace
+    */
+    static std::string json();
+
+    /**
+     * Write json() to a file
+     * @param std::string path the file to write
+    */
+    static void write(const std::string &path);
+};
+#endif
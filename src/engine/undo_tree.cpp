@@ -0,0 +1,74 @@
+#include "undo_tree.hpp"
+
+UndoTree::UndoTree() {
+    clear();
+}
+
+void UndoTree::clear() {
+    nodes.assign(1, {root, 0, 0, 0, 0, {'\0', false, false}});
+}
+
+unsigned int UndoTree::child(
+    unsigned int node,
+    const MoveSequence::Step &step
+) {
+    unsigned int *link = &nodes[node].first_child;
+
+    // A node has at most one child per direction, so the list is short
+    while (*link) {
+        if (nodes[*link].step.direction == step.direction) {
+            return *link;
+        }
+
+        link = &nodes[*link].next_sibling;
+    }
+
+    const unsigned int added = nodes.size();
+    *link = added;
+    nodes.push_back({node, nodes[node].depth + 1, 0, 0, 0, step});
+    return added;
+}
+
+unsigned int UndoTree::common_ancestor(unsigned int a, unsigned int b) const {
+    while (nodes[a].depth > nodes[b].depth) {
+        a = nodes[a].parent;
+    }
+
+    while (nodes[b].depth > nodes[a].depth) {
+        b = nodes[b].parent;
+    }
+
+    while (a != b) {
+        a = nodes[a].parent;
+        b = nodes[b].parent;
+    }
+
+    return a;
+}
+
+std::vector<unsigned int> UndoTree::children(unsigned int node) const {
+    std::vector<unsigned int> result;
+
+    for (unsigned int c = nodes[node].first_child; c;
+         c = nodes[c].next_sibling) {
+        result.push_back(c);
+    }
+
+    return result;
+}
+
+UndoTree::Node &UndoTree::operator[](unsigned int node) {
+    return nodes[node];
+}
+
+const UndoTree::Node &UndoTree::operator[](unsigned int node) const {
+    return nodes[node];
+}
+
+unsigned int UndoTree::size() const {
+    return nodes.size();
+}
+
+unsigned long UndoTree::bytes() const {
+    return nodes.capacity() * sizeof(Node);
+}
@@ -0,0 +1,89 @@
+#ifndef __UNDO_TREE_H__
+#define __UNDO_TREE_H__
+
+#include <vector>
+
+#include "move_sequence.hpp"
+
+/**
+ * Every line of moves explored on a level. Each node is the move that
+ * leads to it from its parent, which is all it takes to step along an edge
+ * in either direction, so no node holds a board. Undoing and then moving
+ * differently adds a sibling instead of discarding the old line, and any
+ * two nodes are joined through their common ancestor in as many steps as
+ * lie between them.
+*/
+class UndoTree {
+public:
+    struct Node {
+        unsigned int parent;
+        unsigned int depth;
+        unsigned int first_child;
+        unsigned int next_sibling;
+
+        /**
+         * The child redo() steps into: the one last undone out of, or 0
+        */
+        unsigned int redo;
+        MoveSequence::Step step;
+    };
+
+    /**
+     * The node for the level's starting position; 0 is never a child, so
+     * it also stands for "none" in the links above
+    */
+    static const unsigned int root = 0;
+
+private:
+    std::vector<Node> nodes;
+
+public:
+    /**
+     * Constructor for a tree holding only the root
+    */
+    UndoTree();
+
+    /**
+     * Remove every node but the root
+    */
+    void clear();
+
+    /**
+     * Return the child reached from a node by a move, adding it if the
+     * move hasn't been made from there before
+     * @param unsigned int node the parent
+     * @param MoveSequence::Step step the move; an existing child keeps
+     * the step it was added with
+     * @return unsigned int the child
+    */
+    unsigned int child(unsigned int node, const MoveSequence::Step &step);
+
+    /**
+     * Return the deepest node that is an ancestor of both nodes, or
+     * either one itself
+     * @param unsigned int a a node
+     * @param unsigned int b another node
+     * @return unsigned int the common ancestor
+    */
+    unsigned int common_ancestor(unsigned int a, unsigned int b) const;
+
+    /**
+     * @param unsigned int node a node, which must exist
+     * @return std::vector<unsigned int> the node's children, oldest first
+    */
+    std::vector<unsigned int> children(unsigned int node) const;
+
+    Node &operator[](unsigned int node);
+    const Node &operator[](unsigned int node) const;
+
+    /**
+     * @return unsigned int the number of nodes, including the root
+    */
+    unsigned int size() const;
+
+    /**
+     * @return unsigned long the heap bytes the tree holds
+    */
+    unsigned long bytes() const;
+};
+#endif
@@ -0,0 +1,195 @@
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hint.hpp"
+#include "solver.hpp"
+#include "trace.hpp"
+
+/**
+ * The engine as built for a Web Worker: only the expensive searches, with
+ * no levels or games of its own. Boards arrive as the text
+ * sokoban_board_to_string() returns, and a solve runs in slices of a node
+ * budget so the worker can post progress and take a cancellation between
+ * them. The Solver keeps its search between slices.
+*/
+
+static std::unique_ptr<Solver> solver;
+static Solver::Options options;
+static Solver::Result result;
+static std::string solution;
+static std::string stats;
+static std::string trace;
+
+static std::unique_ptr<Hint> hint;
+static int hint_level = -1;
+static std::string hint_move;
+
+/**
+ * Split a board's text into its rows
+ * @param const char * text the rows joined by newlines
+ * @return std::vector<std::string> the rows
+*/
+static std::vector<std::string> rows(const char *text) {
+    std::istringstream in(text);
+    std::vector<std::string> board;
+
+    for (std::string row; std::getline(in, row);) {
+        board.push_back(row);
+    }
+
+    return board;
+}
+
+extern "C" {
+
+/**
+ * Start solving a board, replacing any search in progress
+ * @param const char * board the rows joined by newlines
+ * @param int weight the heuristic weight; 1 looks for an optimal solution
+ * @param bool first stop at the first solution instead of proving it
+ * @param int threads the threads generating successors; more than 1 only
+ * helps in the build with pthreads
+ * @return bool true if the board can be searched, false if it's invalid
+*/
+bool solver_start(const char *board, int weight, bool first, int threads) {
+    solver.reset();
+
+    try {
+        solver = std::make_unique<Solver>(rows(board));
+    }
+    catch (const std::invalid_argument &) {
+        return false;
+    }
+
+    options = Solver::Options();
+    options.weight = weight < 1 ? 1 : weight;
+    options.first = first;
+    options.threads = threads < 1 ? 1 : threads;
+    result = {Solver::BUDGET_EXHAUSTED, "", false, 0, 0, 0};
+    solution.clear();
+    return true;
+}
+
+/**
+ * Continue the search for up to a number of node expansions
+ * @param int nodes the slice's budget
+ * @return int the Solver::Status the slice ended with; BUDGET_EXHAUSTED
+ * means there's more to do
+*/
+int solver_run(int nodes) {
+    if (!solver) {
+        return Solver::CANCELLED;
+    }
+
+    options.node_limit = nodes < 1 ? 1 : nodes;
+    result = solver->solve(options);
+    solution = result.solution;
+    return result.status;
+}
+
+/**
+ * @return int the nodes expanded so far by the current search
+*/
+int solver_nodes() {
+    return result.nodes;
+}
+
+/**
+ * @return int the lower bound on the optimal push count
+*/
+int solver_bound() {
+    return result.bound;
+}
+
+/**
+ * @return bool true if the last slice's solution is proven optimal
+*/
+bool solver_optimal() {
+    return result.optimal;
+}
+
+/**
+ * @return const char * the best LURD line found so far
+*/
+const char *solver_solution() {
+    return solution.c_str();
+}
+
+/**
+ * Return the time the current search has spent in each phase, which only
+ * builds compiled with -DSOKOBAN_STATS keep
+ * @return const char * a JSON object of the Solver::Stats fields in
+ * milliseconds, all 0 in other builds or with no search
+*/
+const char *solver_stats() {
+    const Solver::Stats times = solver ? solver->stats() : Solver::Stats();
+    const auto ms = [](std::chrono::nanoseconds time) {
+        return std::to_string(time.count() / 1e6);
+    };
+    stats = "{\"select\": " + ms(times.select) +
+        ", \"generate\": " + ms(times.generate) +
+        ", \"expand\": " + ms(times.expand) + "}";
+    return stats.c_str();
+}
+
+/**
+ * Start recording the solver's phases as trace events, discarding any
+ * earlier trace; only builds compiled with -DSOKOBAN_STATS record them
+*/
+void solver_trace_start() {
+    Trace::start();
+}
+
+/**
+ * Stop recording and return the trace
+ * @return const char * the events as Chrome trace-event JSON, valid until
+ * the next call
+*/
+const char *solver_trace_stop() {
+    Trace::stop();
+    trace = Trace::json();
+    return trace.c_str();
+}
+
+/**
+ * Drop the current search and free its memory
+*/
+void solver_stop() {
+    solver.reset();
+}
+
+/**
+ * Return the next move towards solving a board. The solution is cached
+ * per level as in sokoban_hint(), so hints along it are a lookup.
+ * @param int level the level number the board is from
+ * @param const char * board the rows joined by newlines
+ * @return const char * the move, or "" when solved or no solution was found
+*/
+const char *worker_hint(int level, const char *board) {
+    const std::vector<std::string> current = rows(board);
+
+    try {
+        if (!hint || hint_level != level) {
+            hint = std::make_unique<Hint>(current);
+            hint_level = level;
+        }
+
+        const char move = hint->next(current);
+        hint_move = move ? std::string(1, move) : "";
+    }
+    catch (const std::invalid_argument &) {
+        hint.reset();
+        hint_move = "";
+    }
+
+    return hint_move.c_str();
+}
+
+} // extern "C"
+
+int main() {
+}
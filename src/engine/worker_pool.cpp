@@ -0,0 +1,63 @@
+#include "worker_pool.hpp"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int size) {
+    for (unsigned int i = 1; i < std::max(1u, size); i++) {
+        threads.emplace_back(&WorkerPool::work, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::work(unsigned int index) {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        wake.wait(lock, [&]() { return stopping || runs != seen; });
+
+        if (stopping) {
+            return;
+        }
+
+        seen = runs;
+        const std::function<void(unsigned int)> &job = *this->job;
+        lock.unlock();
+        job(index);
+        lock.lock();
+
+        if (--running == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+unsigned int WorkerPool::size() const {
+    return threads.size() + 1;
+}
+
+void WorkerPool::run(const std::function<void(unsigned int)> &job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        running = threads.size();
+        runs++;
+    }
+
+    wake.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return running == 0; });
+}
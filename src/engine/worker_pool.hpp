@@ -0,0 +1,64 @@
+#ifndef __WORKER_POOL_H__
+#define __WORKER_POOL_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Threads kept waiting between runs of a job, so work split into many
+ * small batches pays for starting its threads once rather than per batch.
+ * The caller's thread takes part in every run as worker 0.
+*/
+class WorkerPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+
+    /**
+     * Signalled when a run starts or the pool is destroyed, and when the
+     * last worker finishes its share of a run
+    */
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(unsigned int)> *job = nullptr;
+    unsigned long runs = 0;
+    unsigned int running = 0;
+    bool stopping = false;
+
+    /**
+     * Wait for each run and do worker index's share of it
+     * @param unsigned int index the worker's number, from 1
+    */
+    void work(unsigned int index);
+
+public:
+    /**
+     * Constructor which starts every worker but the caller's
+     * @param unsigned int size the number of workers, at least 1
+    */
+    WorkerPool(unsigned int size);
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * Stop and join the workers
+    */
+    ~WorkerPool();
+
+    /**
+     * @return unsigned int the number of workers, the caller's included
+    */
+    unsigned int size() const;
+
+    /**
+     * Call a job once on every worker, with the worker's number from 0 to
+     * size() - 1, and return when all of them have finished
+     * @param std::function<void(unsigned int)> job the work to share out
+    */
+    void run(const std::function<void(unsigned int)> &job);
+};
+#endif
@@ -0,0 +1,87 @@
+#include "game_client.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+GameClient::GameClient(const std::string &path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Bad socket path " + path);
+    }
+
+    std::strcpy(address.sun_path, path.c_str());
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd == -1 ||
+        connect(fd, (sockaddr *) &address, sizeof(address)) == -1) {
+        const int error = errno;
+
+        if (fd != -1) {
+            close(fd);
+        }
+
+        throw std::system_error(error, std::generic_category(), "connect");
+    }
+}
+
+GameClient::~GameClient() {
+    close(fd);
+}
+
+void GameClient::send(const Protocol::Request &request) {
+    Protocol::encode(request, output);
+}
+
+void GameClient::flush() {
+    size_t sent = 0;
+
+    while (sent < output.size()) {
+        const ssize_t count = ::send(fd, output.data() + sent,
+            output.size() - sent, MSG_NOSIGNAL);
+
+        if (count == -1 && errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "send");
+        }
+
+        sent += count == -1 ? 0 : count;
+    }
+
+    output.clear();
+}
+
+Protocol::Response GameClient::receive() {
+    Protocol::Response response;
+
+    while (!Protocol::decode(input, offset, response)) {
+        char buffer[65536];
+        const ssize_t count = read(fd, buffer, sizeof(buffer));
+
+        if (count == 0) {
+            throw std::invalid_argument("The server closed the connection");
+        }
+        else if (count == -1 && errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+
+        // Drop consumed frames before growing the buffer
+        input.erase(0, offset);
+        offset = 0;
+        input.append(buffer, count == -1 ? 0 : count);
+    }
+
+    return response;
+}
+
+Protocol::Response GameClient::call(const Protocol::Request &request) {
+    send(request);
+    flush();
+    return receive();
+}
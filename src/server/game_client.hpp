@@ -0,0 +1,58 @@
+#ifndef __GAME_CLIENT_H__
+#define __GAME_CLIENT_H__
+
+#include <string>
+
+#include "protocol.hpp"
+
+/**
+ * A blocking connection to a GameServer. Requests are buffered by send()
+ * until flush(), so many can go out in one write and be answered in one
+ * batch.
+*/
+class GameClient {
+    int fd = -1;
+    std::string input;
+    std::string output;
+    size_t offset = 0;
+
+public:
+    /**
+     * Constructor which connects to a server's socket
+     * @param std::string path the socket's path
+    */
+    GameClient(const std::string &path);
+
+    GameClient(const GameClient &) = delete;
+    GameClient &operator=(const GameClient &) = delete;
+
+    /**
+     * Disconnect, which ends every session this client created
+    */
+    ~GameClient();
+
+    /**
+     * Queue a request
+     * @param Protocol::Request request the request
+    */
+    void send(const Protocol::Request &request);
+
+    /**
+     * Write every queued request
+    */
+    void flush();
+
+    /**
+     * Wait for the next response
+     * @return Protocol::Response the response
+    */
+    Protocol::Response receive();
+
+    /**
+     * Send one request and wait for its response
+     * @param Protocol::Request request the request
+     * @return Protocol::Response the response
+    */
+    Protocol::Response call(const Protocol::Request &request);
+};
+#endif
@@ -0,0 +1,387 @@
+#include "game_server.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * Throw the error a failed system call left in errno
+*/
+void fail(const std::string &call) {
+    throw std::system_error(errno, std::generic_category(), call);
+}
+
+/**
+ * Register a file descriptor with an epoll instance
+*/
+void watch(int epoll, int fd, unsigned int events) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+
+    if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) == -1) {
+        fail("epoll_ctl");
+    }
+}
+
+}
+
+GameServer::GameServer(
+    std::shared_ptr<const LevelStore> levels,
+    const Options &options
+) : levels(std::move(levels)), options(options) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (options.path.empty() ||
+        options.path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Bad socket path " + options.path);
+    }
+    else if (options.threads == 0) {
+        throw std::invalid_argument("A server needs at least one thread");
+    }
+
+    std::strcpy(address.sun_path, options.path.c_str());
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (listener == -1) {
+        fail("socket");
+    }
+
+    unlink(options.path.c_str());
+
+    if (bind(listener, (sockaddr *) &address, sizeof(address)) == -1 ||
+        listen(listener, SOMAXCONN) == -1) {
+        const int error = errno;
+        close(listener);
+        throw std::system_error(error, std::generic_category(), "bind");
+    }
+
+    for (unsigned int i = 0; i < options.threads; i++) {
+        shards.push_back(std::make_unique<Shard>());
+        Shard &shard = *shards.back();
+        shard.epoll = epoll_create1(EPOLL_CLOEXEC);
+        shard.wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        shard.spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+        if (shard.epoll == -1 || shard.wake == -1) {
+            fail("epoll_create1");
+        }
+        else if (shard.spare == -1) {
+            fail("open");
+        }
+
+        watch(shard.epoll, shard.wake, EPOLLIN);
+
+        // Exclusive, so a new connection wakes one shard rather than all
+        watch(shard.epoll, listener, EPOLLIN | EPOLLEXCLUSIVE);
+    }
+}
+
+GameServer::~GameServer() {
+    for (const std::unique_ptr<Shard> &shard : shards) {
+        for (const auto &[fd, _] : shard->connections) {
+            close(fd);
+        }
+
+        close(shard->epoll);
+        close(shard->wake);
+
+        if (shard->spare != -1) {
+            close(shard->spare);
+        }
+    }
+
+    close(listener);
+    unlink(options.path.c_str());
+}
+
+void GameServer::run() {
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 1; i < shards.size(); i++) {
+        workers.emplace_back([this, i]() { serve(*shards[i]); });
+    }
+
+    serve(*shards[0]);
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void GameServer::stop() {
+    const unsigned long long one = 1;
+
+    for (const std::unique_ptr<Shard> &shard : shards) {
+        if (write(shard->wake, &one, sizeof(one)) == -1) {
+            // The counter is already set, so the shard will wake anyway
+        }
+    }
+}
+
+void GameServer::serve(Shard &shard) {
+    epoll_event events[128];
+
+    for (;;) {
+        const int ready = epoll_wait(shard.epoll, events, 128, -1);
+
+        if (ready == -1 && errno != EINTR) {
+            fail("epoll_wait");
+        }
+
+        for (int i = 0; i < ready; i++) {
+            const int fd = events[i].data.fd;
+
+            if (fd == shard.wake) {
+                return;
+            }
+            else if (fd == listener) {
+                accept(shard);
+            }
+            else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                disconnect(shard, fd);
+            }
+            else if (events[i].events & EPOLLOUT) {
+                flush(shard, fd);
+            }
+            else {
+                receive(shard, fd);
+            }
+        }
+    }
+}
+
+void GameServer::accept(Shard &shard) {
+    for (;;) {
+        const int fd = accept4(listener, nullptr, nullptr,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd != -1) {
+            shard.connections[fd];
+            watch(shard.epoll, fd, EPOLLIN | EPOLLRDHUP);
+        }
+        else if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+        else if ((errno == EMFILE || errno == ENFILE) && shard.spare != -1) {
+            // Free the spare to take the connection, refuse it and take
+            // the spare back; if another thread gets the descriptor first,
+            // the next failure gives up until the shard wakes again
+            close(shard.spare);
+            const int refused = accept4(listener, nullptr, nullptr,
+                SOCK_CLOEXEC);
+
+            if (refused != -1) {
+                close(refused);
+            }
+
+            shard.spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        }
+        else {
+            return;
+        }
+    }
+}
+
+void GameServer::receive(Shard &shard, int fd) {
+    Connection &connection = shard.connections.at(fd);
+    char buffer[65536];
+
+    // Requests are answered as each read arrives, so reading stops as soon
+    // as the replies waiting pass the output limit
+    while (connection.output.size() <= options.output_limit) {
+        const ssize_t count = read(fd, buffer, sizeof(buffer));
+
+        if (count == -1 && errno == EINTR) {
+            continue;
+        }
+        else if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else if (count <= 0) {
+            disconnect(shard, fd);
+            return;
+        }
+
+        connection.input.append(buffer, count);
+        size_t offset = 0;
+        Protocol::Request request;
+
+        try {
+            while (Protocol::decode(connection.input, offset, request)) {
+                Protocol::encode(handle(shard, connection, request),
+                    connection.output);
+            }
+        }
+        catch (const std::invalid_argument &) {
+            // The stream can't be framed any more
+            disconnect(shard, fd);
+            return;
+        }
+
+        connection.input.erase(0, offset);
+    }
+
+    flush(shard, fd);
+}
+
+void GameServer::flush(Shard &shard, int fd) {
+    Connection &connection = shard.connections.at(fd);
+    size_t sent = 0;
+
+    while (sent < connection.output.size()) {
+        const ssize_t count = send(fd, connection.output.data() + sent,
+            connection.output.size() - sent, MSG_NOSIGNAL);
+
+        if (count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                disconnect(shard, fd);
+                return;
+            }
+
+            break;
+        }
+
+        sent += count;
+    }
+
+    connection.output.erase(0, sent);
+
+    // A client sending faster than it reads is only watched for taking
+    // its replies until they're back within the limit, so they can't pile
+    // up without bound; a hangup is still reported
+    epoll_event event = {};
+    event.events = EPOLLOUT;
+
+    if (connection.output.size() <= options.output_limit) {
+        event.events = EPOLLIN | EPOLLRDHUP |
+            (connection.output.empty() ? 0 : EPOLLOUT);
+    }
+    event.data.fd = fd;
+    epoll_ctl(shard.epoll, EPOLL_CTL_MOD, fd, &event);
+}
+
+void GameServer::disconnect(Shard &shard, int fd) {
+    for (const unsigned int session : shard.connections.at(fd).sessions) {
+        shard.sessions.destroy(session);
+    }
+
+    shard.connections.erase(fd);
+    epoll_ctl(shard.epoll, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+}
+
+Protocol::Response GameServer::handle(
+    Shard &shard,
+    Connection &connection,
+    const Protocol::Request &request
+) {
+    Protocol::Response response = {Protocol::OK, request.tag, ""};
+
+    try {
+        if (request.op == Protocol::CREATE) {
+            const unsigned int session = shard.sessions.create(levels);
+
+            try {
+                if (!request.payload.empty()) {
+                    shard.sessions.at(session).soko.change_level(
+                        Protocol::get(request.payload, 0, 4)
+                    );
+                }
+            }
+            catch (const std::exception &) {
+                shard.sessions.destroy(session);
+                throw;
+            }
+
+            connection.sessions.insert(session);
+            Protocol::put(response.payload, session, 4);
+            return response;
+        }
+        else if (request.op == Protocol::SHARDS) {
+            Protocol::put(response.payload, shards.size(), 4);
+            return response;
+        }
+        else if (!connection.sessions.count(request.session)) {
+            throw std::invalid_argument(
+                "No session with handle " + std::to_string(request.session)
+            );
+        }
+
+        Sokoban &soko = shard.sessions.at(request.session).soko;
+
+        if (request.op == Protocol::DESTROY) {
+            shard.sessions.destroy(request.session);
+            connection.sessions.erase(request.session);
+        }
+        else if (request.op == Protocol::MOVE) {
+            unsigned int moves = 0;
+
+            for (const char c : request.payload) {
+                const char direction = std::toupper(c);
+
+                if (std::strchr("UDLR", direction) && direction != '\0' &&
+                    soko.move((Sokoban::Direction) direction)) {
+                    moves++;
+                }
+            }
+
+            Protocol::put(response.payload, moves, 4);
+            Protocol::put(response.payload, soko.solved(), 1);
+        }
+        else if (request.op == Protocol::UNDO) {
+            Protocol::put(response.payload, soko.undo(), 1);
+        }
+        else if (request.op == Protocol::RESET) {
+            soko.reset();
+        }
+        else if (request.op == Protocol::LEVEL) {
+            soko.change_level(Protocol::get(request.payload, 0, 4));
+        }
+        else if (request.op == Protocol::BOARD) {
+            for (const std::string &row : soko.board()) {
+                response.payload += row + "\n";
+            }
+
+            response.payload.pop_back();
+        }
+        else if (request.op == Protocol::SEQUENCE) {
+            response.payload = soko.sequence();
+        }
+        else if (request.op == Protocol::SOLVED) {
+            Protocol::put(response.payload, soko.solved(), 1);
+        }
+        else if (request.op == Protocol::SAVE) {
+            response.payload = soko.serialize();
+        }
+        else if (request.op == Protocol::RESTORE) {
+            soko.deserialize(request.payload);
+        }
+        else {
+            throw std::invalid_argument(
+                "Unknown op " + std::to_string(request.op)
+            );
+        }
+    }
+    catch (const std::exception &e) {
+        response = {Protocol::ERROR, request.tag, e.what()};
+    }
+
+    return response;
+}
@@ -0,0 +1,150 @@
+#ifndef __GAME_SERVER_H__
+#define __GAME_SERVER_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../engine/level_store.hpp"
+#include "../engine/session_pool.hpp"
+#include "protocol.hpp"
+
+/**
+ * Hosts games for clients on a Unix-domain socket. The work is sharded
+ * across threads, each with its own epoll loop, connections and session
+ * pool, so the shards share nothing but the immutable levels and never
+ * lock. Every shard waits on the listening socket and the kernel wakes
+ * one of them per new connection, whose sessions then stay on that shard.
+ * All the requests a connection has sent by the time its shard wakes are
+ * answered with a single write, up to the output limit.
+*/
+class GameServer {
+public:
+    struct Options {
+        /**
+         * The socket's path, replaced if it exists and removed on exit
+        */
+        std::string path;
+
+        /**
+         * The number of shards, each on its own thread
+        */
+        unsigned int threads = 1;
+
+        /**
+         * Bytes of replies a connection may have waiting before the server
+         * stops reading its requests, until the client takes them
+        */
+        size_t output_limit = 1 << 20;
+    };
+
+private:
+    struct Connection {
+        std::string input;
+        std::string output;
+
+        /**
+         * The sessions this connection created, the only ones it may use;
+         * they are destroyed when it disconnects
+        */
+        std::unordered_set<unsigned int> sessions;
+    };
+
+    struct Shard {
+        int epoll = -1;
+        int wake = -1;
+
+        /**
+         * A descriptor held in reserve, given up to accept and close a
+         * connection when the process has run out of them
+        */
+        int spare = -1;
+        SessionPool sessions;
+        std::unordered_map<int, Connection> connections;
+    };
+
+    std::shared_ptr<const LevelStore> levels;
+    Options options;
+    int listener = -1;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    /**
+     * Run a shard's event loop until stop() is called
+     * @param Shard shard the shard
+    */
+    void serve(Shard &shard);
+
+    /**
+     * Accept every pending connection, closing them again while the
+     * process is out of descriptors, since the listener would otherwise
+     * stay readable and keep waking the shard
+     * @param Shard shard the shard that was woken
+    */
+    void accept(Shard &shard);
+
+    /**
+     * Read what a connection has sent and answer every complete request,
+     * until the replies waiting pass the output limit
+     * @param Shard shard the connection's shard
+     * @param int fd the connection
+    */
+    void receive(Shard &shard, int fd);
+
+    /**
+     * Write as much of a connection's pending output as the socket takes,
+     * watching for writability while any remains and for requests only
+     * while it's within the output limit
+     * @param Shard shard the connection's shard
+     * @param int fd the connection
+    */
+    void flush(Shard &shard, int fd);
+
+    /**
+     * Close a connection and destroy its sessions
+     * @param Shard shard the connection's shard
+     * @param int fd the connection
+    */
+    void disconnect(Shard &shard, int fd);
+
+    /**
+     * Carry out a request
+     * @param Shard shard the shard the request arrived on
+     * @param Connection connection the connection that sent it
+     * @param Protocol::Request request the request
+     * @return Protocol::Response the reply
+    */
+    Protocol::Response handle(Shard &shard, Connection &connection,
+        const Protocol::Request &request);
+
+public:
+    /**
+     * Constructor which binds and listens on the socket, so clients can
+     * connect as soon as it returns
+     * @param std::shared_ptr<const LevelStore> levels the levels to serve
+     * @param Options options the socket and thread count
+    */
+    GameServer(std::shared_ptr<const LevelStore> levels,
+        const Options &options);
+
+    GameServer(const GameServer &) = delete;
+    GameServer &operator=(const GameServer &) = delete;
+
+    /**
+     * Close every connection and remove the socket
+    */
+    ~GameServer();
+
+    /**
+     * Serve until stop() is called, using the calling thread as one of the
+     * shards
+    */
+    void run();
+
+    /**
+     * Make run() return; safe to call from any thread or a signal handler
+    */
+    void stop();
+};
+#endif
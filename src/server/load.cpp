@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_client.hpp"
+
+/**
+ * Settings for a load run, all from the command line
+*/
+struct Load {
+    std::string path;
+    unsigned int connections = 4;
+    unsigned int sessions = 250;
+    unsigned int requests = 100;
+    unsigned int depth = 32;
+};
+
+/**
+ * Drive one connection: create its sessions, then keep up to depth
+ * requests in flight, spread across its sessions, until each session has
+ * had its share
+ * @param Load load the run's settings
+ * @param unsigned int seed seeds the random moves
+ * @return std::vector<double> the latency of every request, in microseconds
+*/
+std::vector<double> drive(const Load &load, unsigned int seed) {
+    using Clock = std::chrono::steady_clock;
+    GameClient client(load.path);
+    std::vector<unsigned int> sessions;
+
+    for (unsigned int i = 0; i < load.sessions; i++) {
+        client.send({Protocol::CREATE, i, 0, ""});
+    }
+
+    client.flush();
+
+    for (unsigned int i = 0; i < load.sessions; i++) {
+        const Protocol::Response response = client.receive();
+
+        if (response.status != Protocol::OK) {
+            throw std::invalid_argument(response.payload);
+        }
+
+        sessions.push_back(Protocol::get(response.payload, 0, 4));
+    }
+
+    const unsigned long total = (unsigned long) load.sessions * load.requests;
+    std::vector<Clock::time_point> sent(total);
+    std::vector<double> latencies;
+    latencies.reserve(total);
+    std::mt19937 random(seed);
+    unsigned long next = 0;
+
+    while (latencies.size() < total) {
+        for (; next < total && next - latencies.size() < load.depth; next++) {
+            const unsigned int session = sessions[next % sessions.size()];
+            const unsigned int kind = random() % 10;
+
+            // Mostly moves, with the occasional undo and board fetch
+            Protocol::Op op = Protocol::MOVE;
+
+            if (kind == 8) {
+                op = Protocol::UNDO;
+            }
+            else if (kind == 9) {
+                op = Protocol::BOARD;
+            }
+
+            const std::string move(1, "UDLR"[random() % 4]);
+            sent[next] = Clock::now();
+            client.send({op, (unsigned int) next, session,
+                op == Protocol::MOVE ? move : ""});
+        }
+
+        client.flush();
+
+        // Wait for one reply, then take every other one already here
+        do {
+            const Protocol::Response response = client.receive();
+            latencies.push_back(std::chrono::duration<double, std::micro>(
+                Clock::now() - sent[response.tag]).count());
+        } while (latencies.size() < next &&
+                 next - latencies.size() >= load.depth / 2);
+    }
+
+    return latencies;
+}
+
+/**
+ * Generates load against a running sokoban_server and reports request
+ * latency, and the sessions and throughput per shard, counting the shards
+ * the server says it runs.
+ *
+ * Usage: sokoban_load <socket path> [connections] [sessions per connection]
+ *     [requests per session] [pipeline depth]
+*/
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 6) {
+        std::cerr << "Usage: " << argv[0] << " <socket path> [connections]"
+                  << " [sessions per connection] [requests per session]"
+                  << " [pipeline depth]\n";
+        return 1;
+    }
+
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    Load load;
+    load.path = args[0];
+    std::vector<unsigned int *> settings = {&load.connections,
+        &load.sessions, &load.requests, &load.depth};
+
+    for (unsigned int i = 1; i < args.size(); i++) {
+        *settings[i - 1] = std::max(1ul, std::stoul(args[i]));
+    }
+
+    unsigned int shards = 0;
+
+    try {
+        GameClient client(load.path);
+        const Protocol::Response response =
+            client.call({Protocol::SHARDS, 0, 0, ""});
+
+        if (response.status != Protocol::OK) {
+            throw std::invalid_argument(response.payload);
+        }
+
+        shards = std::max(1u, Protocol::get(response.payload, 0, 4));
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<std::vector<double>> results(load.connections);
+    std::vector<std::thread> threads;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < load.connections; i++) {
+        threads.emplace_back([&, i]() {
+            try {
+                results[i] = drive(load, i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                error = std::current_exception();
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    if (error) {
+        try {
+            std::rethrow_exception(error);
+        }
+        catch (const std::exception &e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<double> latencies;
+
+    for (const std::vector<double> &result : results) {
+        latencies.insert(latencies.end(), result.begin(), result.end());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const unsigned long sessions =
+        (unsigned long) load.connections * load.sessions;
+    const auto percentile = [&](double p) {
+        return latencies[(size_t) (p * (latencies.size() - 1))];
+    };
+
+    std::cout << "requests       " << latencies.size() << "\n"
+              << "sessions       " << sessions << "\n"
+              << "seconds        " << seconds << "\n"
+              << "requests/s     " << latencies.size() / seconds << "\n"
+              << "p50 us         " << percentile(0.5) << "\n"
+              << "p99 us         " << percentile(0.99) << "\n"
+              << "shards         " << shards << "\n"
+              << "sessions/shard " << sessions / shards << "\n"
+              << "requests/s/shard "
+              << latencies.size() / seconds / shards << "\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "protocol.hpp"
+
+#include <stdexcept>
+#include <string>
+
+void Protocol::put(std::string &out, unsigned int value, unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; i++) {
+        out.push_back((char) (value >> (8 * i)));
+    }
+}
+
+unsigned int Protocol::get(
+    const std::string &in,
+    size_t offset,
+    unsigned int bytes
+) {
+    if (offset + bytes > in.size()) {
+        throw std::invalid_argument("Truncated message");
+    }
+
+    unsigned int value = 0;
+
+    for (unsigned int i = 0; i < bytes; i++) {
+        value |= (unsigned int) (unsigned char) in[offset + i] << (8 * i);
+    }
+
+    return value;
+}
+
+void Protocol::encode(const Request &request, std::string &out) {
+    put(out, request.payload.size(), 4);
+    put(out, request.op, 1);
+    put(out, request.tag, 4);
+    put(out, request.session, 4);
+    out += request.payload;
+}
+
+void Protocol::encode(const Response &response, std::string &out) {
+    put(out, response.payload.size(), 4);
+    put(out, response.status, 1);
+    put(out, response.tag, 4);
+    out += response.payload;
+}
+
+bool Protocol::decode(
+    const std::string &in,
+    size_t &offset,
+    Request &request
+) {
+    if (in.size() - offset < request_header) {
+        return false;
+    }
+
+    const unsigned int length = get(in, offset, 4);
+
+    if (length > max_payload) {
+        throw std::invalid_argument("Request too large");
+    }
+    else if (in.size() - offset - request_header < length) {
+        return false;
+    }
+
+    // Casting a byte outside the enumerators to Op is undefined
+    const unsigned int op = get(in, offset + 4, 1);
+
+    if (op < CREATE || op > SHARDS) {
+        throw std::invalid_argument("Unknown op " + std::to_string(op));
+    }
+
+    request.op = (Op) op;
+    request.tag = get(in, offset + 5, 4);
+    request.session = get(in, offset + 9, 4);
+    request.payload.assign(in, offset + request_header, length);
+    offset += request_header + length;
+    return true;
+}
+
+bool Protocol::decode(
+    const std::string &in,
+    size_t &offset,
+    Response &response
+) {
+    if (in.size() - offset < response_header) {
+        return false;
+    }
+
+    const unsigned int length = get(in, offset, 4);
+
+    if (length > max_payload) {
+        throw std::invalid_argument("Response too large");
+    }
+    else if (in.size() - offset - response_header < length) {
+        return false;
+    }
+
+    const unsigned int status = get(in, offset + 4, 1);
+
+    if (status > ERROR) {
+        throw std::invalid_argument(
+            "Unknown status " + std::to_string(status)
+        );
+    }
+
+    response.status = (Status) status;
+    response.tag = get(in, offset + 5, 4);
+    response.payload.assign(in, offset + response_header, length);
+    offset += response_header + length;
+    return true;
+}
@@ -0,0 +1,123 @@
+#ifndef __PROTOCOL_H__
+#define __PROTOCOL_H__
+
+#include <string>
+
+/**
+ * The game server's wire format. Every message is a frame with a fixed
+ * little-endian header and a payload whose length the header gives.
+ * Clients may send many requests without waiting; each response echoes
+ * its request's tag, and responses to one connection come in order.
+ *
+ *   request   payload length (4), op (1), tag (4), session (4), payload
+ *   response  payload length (4), status (1), tag (4), payload
+*/
+class Protocol {
+public:
+    /**
+     * What a request asks the server to do, and its payload
+    */
+    enum Op {
+        CREATE = 1,   // optional level (4); replies with the handle (4)
+        DESTROY = 2,  // no payload
+        MOVE = 3,     // directions as "UDLR" bytes; replies with the
+                      // number of moves made (4) and solved (1)
+        UNDO = 4,     // replies with whether the board changed (1)
+        RESET = 5,    // no payload
+        LEVEL = 6,    // level (4)
+        BOARD = 7,    // replies with the rows joined by newlines
+        SEQUENCE = 8, // replies with the moves made so far
+        SOLVED = 9,   // replies with whether the level is solved (1)
+        SAVE = 10,    // replies with the game as Sokoban::serialize()
+        RESTORE = 11, // a blob from SAVE, possibly of another session
+        SHARDS = 12,  // needs no session; replies with the number of
+                      // shards the server runs (4)
+    };
+
+    /**
+     * How a request went; errors carry a message as their payload
+    */
+    enum Status {
+        OK = 0,
+        ERROR = 1,
+    };
+
+    struct Request {
+        Op op;
+        unsigned int tag;
+        unsigned int session;
+        std::string payload;
+    };
+
+    struct Response {
+        Status status;
+        unsigned int tag;
+        std::string payload;
+    };
+
+    static const unsigned int request_header = 13;
+    static const unsigned int response_header = 9;
+
+    /**
+     * Frames with larger payloads are refused, as a malformed stream
+     * would otherwise have the reader buffer without bound
+    */
+    static const unsigned int max_payload = 1 << 20;
+
+    /**
+     * Append a little-endian value to a payload or frame
+     * @param std::string out where to append
+     * @param unsigned int value the value
+     * @param unsigned int bytes the width of the value
+    */
+    static void put(std::string &out, unsigned int value, unsigned int bytes);
+
+    /**
+     * Read a little-endian value
+     * @param std::string in the bytes
+     * @param size_t offset where the value starts
+     * @param unsigned int bytes the width of the value
+     * @return unsigned int the value
+    */
+    static unsigned int get(const std::string &in, size_t offset,
+        unsigned int bytes);
+
+    /**
+     * Append a request frame
+     * @param Request request the request
+     * @param std::string out where to append
+    */
+    static void encode(const Request &request, std::string &out);
+
+    /**
+     * Append a response frame
+     * @param Response response the response
+     * @param std::string out where to append
+    */
+    static void encode(const Response &response, std::string &out);
+
+    /**
+     * Read the next complete request frame from a buffer, throwing for an
+     * op that isn't one of Op's
+     * @param std::string in the bytes received so far
+     * @param size_t offset where the frame starts, moved past it if read
+     * @param Request request set to the request
+     * @return bool true if a whole frame was read, false if more bytes are
+     * needed
+    */
+    static bool decode(const std::string &in, size_t &offset,
+        Request &request);
+
+    /**
+     * Read the next complete response frame from a buffer, throwing for a
+     * status that isn't one of Status's
+     * @param std::string in the bytes received so far
+     * @param size_t offset where the frame starts, moved past it if read
+     * @param Response response set to the response
+     * @return bool true if a whole frame was read, false if more bytes are
+     * needed
+    */
+    static bool decode(const std::string &in, size_t &offset,
+        Response &response);
+};
+#endif
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <csignal>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../engine/level_pack.hpp"
+#include "../engine/level_parser.hpp"
+#include "../engine/level_store.hpp"
+#include "game_server.hpp"
+
+/**
+ * Serves games over a Unix-domain socket until interrupted.
+ *
+ * Usage: sokoban_server <socket path> [threads] [level pack or directory]
+*/
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <socket path> [threads] [level pack or directory]\n";
+        return 1;
+    }
+
+    try {
+        GameServer::Options options;
+        options.path = argv[1];
+        options.threads = argc > 2 ? std::stoul(argv[2]) :
+            std::max(1u, std::thread::hardware_concurrency());
+        const std::string source = argc > 3 ? argv[3] : "src/engine/levels";
+        LevelPack pack;
+
+        if (std::filesystem::is_directory(source)) {
+            pack = LevelPack(LevelPack::encode(
+                LevelParser::read_directory(source, options.threads)
+            ));
+        }
+        else {
+            pack = LevelPack::load(source);
+        }
+
+        const auto levels = std::make_shared<LevelStore>(std::move(pack));
+
+        // Signals are taken by a waiting thread rather than a handler
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        GameServer server(levels, options);
+        std::thread waiter([&]() {
+            int signal;
+            sigwait(&signals, &signal);
+            server.stop();
+        });
+        waiter.detach();
+
+        std::cout << "Serving " << levels->size() << " levels on "
+                  << options.path << " with " << options.threads
+                  << " threads\n";
+        server.run();
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
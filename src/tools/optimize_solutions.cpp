@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/level_pack.hpp"
+#include "../engine/optimizer.hpp"
+
+/**
+ * A stored solution and the pack level it solves
+*/
+struct Entry {
+    unsigned int level;
+    std::string solution;
+};
+
+/**
+ * Read a solutions file, one "<level number> <moves>" line per solution;
+ * blank lines are skipped
+ * @param std::string path the file to read
+ * @return std::vector<Entry> the solutions in file order
+*/
+std::vector<Entry> read_solutions(const std::string &path) {
+    std::ifstream in(path);
+
+    if (!in) {
+        throw std::invalid_argument("Cannot open file " + path);
+    }
+
+    std::vector<Entry> entries;
+    unsigned int number = 0;
+
+    for (std::string line; std::getline(in, line);) {
+        number++;
+
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        Entry entry;
+
+        if (!(fields >> entry.level >> entry.solution)) {
+            throw std::invalid_argument(
+                path + ":" + std::to_string(number) +
+                ": expected a level number and its moves"
+            );
+        }
+
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+/**
+ * Write a solutions file through a temporary file and a rename, so an
+ * interrupted run leaves the old file whole
+ * @param std::string path the file to write
+ * @param std::vector<Entry> entries the solutions in order
+*/
+void write_solutions(const std::string &path,
+                     const std::vector<Entry> &entries) {
+    const std::string temporary = path + ".tmp";
+
+    {
+        std::ofstream out(temporary);
+
+        for (const Entry &entry : entries) {
+            out << entry.level << ' ' << entry.solution << '\n';
+        }
+
+        if (!out) {
+            throw std::invalid_argument("Cannot write " + temporary);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+
+    if (error) {
+        std::filesystem::remove(path);
+        std::filesystem::rename(temporary, path);
+    }
+}
+
+/**
+ * Shortens stored solutions of a level pack's levels, as an unattended
+ * batch that spreads the levels across every core. Each solution is
+ * replaced only by a shorter valid one; solutions that don't solve their
+ * level are kept and reported.
+ *
+ * Usage: optimize_solutions [--threads n] [--window moves] [--nodes n]
+ *        <level pack> <solutions file> [output file]
+ *
+ * The output defaults to the solutions file itself.
+*/
+int main(int argc, char **argv) {
+    std::vector<std::string> paths;
+    Optimizer::Options options;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool more = i + 1 < argc;
+
+            if (arg == "--threads" && more) {
+                threads = std::max(1ul, std::stoul(argv[++i]));
+            }
+            else if (arg == "--window" && more) {
+                options.window = std::stoul(argv[++i]);
+            }
+            else if (arg == "--nodes" && more) {
+                options.node_limit = std::stoul(argv[++i]);
+            }
+            else {
+                paths.push_back(arg);
+            }
+        }
+    }
+    catch (const std::exception &) {
+        paths.clear();
+    }
+
+    if (paths.size() < 2 || paths.size() > 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--threads n] [--window moves] [--nodes n]"
+                  << " <level pack> <solutions file> [output file]\n";
+        return 1;
+    }
+
+    const std::string &output = paths.back();
+
+    try {
+        const LevelPack pack = LevelPack::load(paths[0]);
+        std::vector<Entry> entries = read_solutions(paths[1]);
+        std::vector<Optimizer::Job> jobs;
+
+        for (const Entry &entry : entries) {
+            if (entry.level >= pack.size()) {
+                throw std::invalid_argument(
+                    "Level " + std::to_string(entry.level) +
+                    " is not in the pack"
+                );
+            }
+
+            jobs.push_back({pack.board(entry.level), entry.solution});
+        }
+
+        const std::vector<std::string> results =
+            Optimizer::optimize(jobs, options, threads);
+        unsigned long before = 0;
+        unsigned long after = 0;
+        unsigned int shortened = 0;
+
+        for (size_t i = 0; i < entries.size(); i++) {
+            const std::string &old = entries[i].solution;
+            before += old.size();
+
+            if (results[i].empty() && !old.empty()) {
+                std::cerr << "Level " << entries[i].level
+                          << ": stored solution is invalid, kept as is\n";
+            }
+            else if (results[i].size() < old.size()) {
+                std::cout << "Level " << entries[i].level << ": "
+                          << old.size() << " -> " << results[i].size()
+                          << " moves\n";
+                entries[i].solution = results[i];
+                shortened++;
+            }
+
+            after += entries[i].solution.size();
+        }
+
+        write_solutions(output, entries);
+        std::cout << "Shortened " << shortened << " of " << entries.size()
+                  << " solutions, " << before << " -> " << after
+                  << " moves, into " << output << "\n";
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
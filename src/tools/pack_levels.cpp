@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/level_pack.hpp"
+#include "../engine/level_parser.hpp"
+
+/**
+ * Quote text as a C++ string literal
+ * @param std::string text the text to quote
+ * @return std::string the literal
+*/
+std::string quote(const std::string &text) {
+    std::ostringstream literal;
+    literal << '"';
+
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            literal << '\\' << c;
+        }
+        else if (c == '\n') {
+            literal << "\\n";
+        }
+        else if ((unsigned char) c < ' ') {
+            literal << "\\x" << std::hex << (int) c << std::dec << "\"\"";
+        }
+        else {
+            literal << c;
+        }
+    }
+
+    literal << '"';
+    return literal.str();
+}
+
+/**
+ * Write levels as C++ source defining EmbeddedLevels' data, with every
+ * board checked by a static_assert when it's compiled
+ * @param std::vector<Level> levels the levels to embed
+ * @param std::ostream out where to write the source
+*/
+void embed(const std::vector<Level> &levels, std::ostream &out) {
+    out << "// Generated by pack_levels --embed; do not edit\n"
+        << "#include \"embedded_levels.hpp\"\n\n"
+        << "namespace {\n";
+
+    for (unsigned int i = 0; i < levels.size(); i++) {
+        const std::string name = "level_" + std::to_string(i);
+        out << "\nconstexpr std::string_view " << name << "[] = {\n";
+
+        for (const std::string &row : levels[i].board) {
+            out << "    " << quote(row) << ",\n";
+        }
+
+        out << "};\nstatic_assert(EmbeddedLevels::valid(" << name << "), "
+            << quote("Level " + std::to_string(i) + " is not playable")
+            << ");\n";
+    }
+
+    out << "\nconstexpr EmbeddedLevels::Entry entries[] = {\n";
+
+    for (unsigned int i = 0; i < levels.size(); i++) {
+        out << "    {level_" << i << ", " << levels[i].board.size() << ", "
+            << quote(levels[i].title) << ", " << quote(levels[i].author)
+            << ", " << quote(levels[i].comment) << "},\n";
+    }
+
+    out << "};\n\n}\n\n"
+        << "const EmbeddedLevels::Entry *const EmbeddedLevels::entries =\n"
+        << "    ::entries;\n"
+        << "const unsigned int EmbeddedLevels::count = "
+        << levels.size() << ";\n";
+}
+
+/**
+ * Packs a directory of .xsb levels and .sok/.txt collections into a single
+ * binary level pack for the engine to load at startup, or with --embed
+ * into C++ source that compiles the levels into the engine.
+ *
+ * Usage: pack_levels [--embed] <level directory> <output file>
+*/
+int main(int argc, char **argv) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    const bool source = !args.empty() && args[0] == "--embed";
+
+    if (args.size() != 2u + source) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--embed] <level directory> <output file>\n";
+        return 1;
+    }
+
+    const std::string &directory = args[source];
+    const std::string &output = args[source + 1];
+
+    try {
+        const unsigned int threads =
+            std::max(1u, std::thread::hardware_concurrency());
+        const std::vector<Level> levels =
+            LevelParser::read_directory(directory, threads);
+        std::ofstream out(output, std::ios::binary);
+
+        if (source) {
+            embed(levels, out);
+        }
+        else {
+            const std::string pack = LevelPack::encode(levels);
+            out.write(pack.data(), pack.size());
+        }
+
+        if (!out) {
+            std::cerr << "Cannot write " << output << "\n";
+            return 1;
+        }
+
+        std::cout << "Packed " << levels.size() << " levels into "
+                  << output << "\n";
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
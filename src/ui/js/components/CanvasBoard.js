@@ -0,0 +1,214 @@
+/**
+ * Draws a board on a canvas, for boards too large to render as a table
+ * cell per square. The element it draws in becomes a scrolling viewport:
+ * a spacer the size of the whole board scrolls behind a canvas the size
+ * of the view, so only the cells in view are ever painted. A batch of
+ * moves repaints just the cells it changed, and the view scrolls to keep
+ * the player in sight.
+*/
+const tileSize = 30;
+
+// The sprite for each cell symbol; cells outside the walls stay clear
+const spriteNames = {
+  " ": "floor",
+  "#": "wall",
+  ".": "goal",
+  "$": "box",
+  "*": "box_on_goal",
+  "@": "player",
+  "+": "player_on_goal",
+};
+
+let spritesLoaded = null;
+
+/**
+ * Load the sprites once for every board
+ * @return Promise<object> an image for each cell symbol
+*/
+const loadSprites = () => {
+  if (!spritesLoaded) {
+    spritesLoaded = Promise.all(
+      Object.entries(spriteNames).map(async ([cell, name]) => {
+        const image = new Image();
+        image.src = `assets/images/${name}.png`;
+        await image.decode();
+        return [cell, image];
+      })
+    ).then(Object.fromEntries);
+  }
+
+  return spritesLoaded;
+};
+
+const CanvasBoard = {
+  /**
+   * Set up a canvas board in an element
+   * @param HTMLElement root the element to draw in
+   * @return object draw(board), update(changes) and cellAt(event)
+  */
+  create(root) {
+    const canvas = document.createElement("canvas");
+    const spacer = document.createElement("div");
+    const ctx = canvas.getContext("2d");
+    root.classList.add("canvas");
+    root.replaceChildren(canvas, spacer);
+
+    let board = [];
+    let sprites = null;
+
+    /**
+     * Paint one cell if it's in view, over whatever was there
+     * @param number row the cell's row
+     * @param number col the cell's column
+    */
+    const paintCell = (row, col) => {
+      const x = col * tileSize - root.scrollLeft;
+      const y = row * tileSize - root.scrollTop;
+
+      if (x <= -tileSize || y <= -tileSize ||
+          x >= root.clientWidth || y >= root.clientHeight) {
+        return;
+      }
+
+      ctx.clearRect(x, y, tileSize, tileSize);
+      const sprite = sprites[board[row][col]];
+
+      if (sprite) {
+        ctx.drawImage(sprite, x, y);
+      }
+    };
+
+    /**
+     * Paint every cell in view and nothing else
+    */
+    const paint = () => {
+      if (!sprites) {
+        return;
+      }
+
+      ctx.clearRect(0, 0, root.clientWidth, root.clientHeight);
+      const top = Math.floor(root.scrollTop / tileSize);
+      const left = Math.floor(root.scrollLeft / tileSize);
+      const bottom = Math.min(
+        board.length,
+        Math.ceil((root.scrollTop + root.clientHeight) / tileSize)
+      );
+
+      for (let row = top; row < bottom; row++) {
+        const right = Math.min(
+          board[row].length,
+          Math.ceil((root.scrollLeft + root.clientWidth) / tileSize)
+        );
+
+        for (let col = left; col < right; col++) {
+          paintCell(row, col);
+        }
+      }
+    };
+
+    /**
+     * Match the canvas to the viewport, which the page's size and the
+     * scrollbars decide, and repaint it
+    */
+    const resize = () => {
+      const ratio = window.devicePixelRatio || 1;
+      const width = root.clientWidth;
+      const height = root.clientHeight;
+      canvas.width = width * ratio;
+      canvas.height = height * ratio;
+      canvas.style.width = `${width}px`;
+      canvas.style.height = `${height}px`;
+
+      // Out of the flow, so the spacer alone sets the scrollable size
+      canvas.style.marginBottom = `-${height}px`;
+      ctx.setTransform(ratio, 0, 0, ratio, 0, 0);
+      ctx.imageSmoothingEnabled = false;
+      paint();
+    };
+
+    /**
+     * Scroll the least distance that keeps a cell and a margin of cells
+     * around it in view
+     * @param number row the cell's row
+     * @param number col the cell's column
+    */
+    const follow = (row, col) => {
+      const margin = 2 * tileSize;
+      const x = col * tileSize;
+      const y = row * tileSize;
+      root.scrollLeft = Math.min(
+        Math.max(root.scrollLeft, x + tileSize + margin - root.clientWidth),
+        x - margin
+      );
+      root.scrollTop = Math.min(
+        Math.max(root.scrollTop, y + tileSize + margin - root.clientHeight),
+        y - margin
+      );
+    };
+
+    root.addEventListener("scroll", paint, {passive: true});
+    new ResizeObserver(resize).observe(root);
+    loadSprites().then(loaded => {
+      sprites = loaded;
+      paint();
+    });
+
+    return {
+      /**
+       * Draw a whole board, as after a level starts, an undo or a long
+       * move, scrolled to the player
+       * @param string[][] cells the cell symbols by row, "_" outside
+      */
+      draw(cells) {
+        board = cells;
+        const width = Math.max(...board.map(row => row.length));
+        root.style.width = `${width * tileSize}px`;
+        root.style.height = `${board.length * tileSize}px`;
+        spacer.style.width = `${width * tileSize}px`;
+        spacer.style.height = `${board.length * tileSize}px`;
+        resize();
+        board.forEach((row, y) => row.forEach((cell, x) => {
+          if (cell === "@" || cell === "+") {
+            follow(y, x);
+          }
+        }));
+      },
+
+      /**
+       * Repaint the cells a batch of moves changed
+       * @param Array changes {row, col, cell} for each changed cell
+      */
+      update(changes) {
+        for (const {row, col, cell} of changes) {
+          board[row][col] = cell;
+
+          if (sprites) {
+            paintCell(row, col);
+          }
+
+          if (cell === "@" || cell === "+") {
+            follow(row, col);
+          }
+        }
+      },
+
+      /**
+       * Find the cell under a mouse event on the canvas
+       * @param MouseEvent event the event
+       * @return object {row, col}, or null if the event missed the canvas
+      */
+      cellAt(event) {
+        if (event.target !== canvas) {
+          return null;
+        }
+
+        return {
+          row: Math.floor((event.offsetY + root.scrollTop) / tileSize),
+          col: Math.floor((event.offsetX + root.scrollLeft) / tileSize),
+        };
+      },
+    };
+  },
+};
+
+export default CanvasBoard;
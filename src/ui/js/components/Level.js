@@ -1,6 +1,8 @@
+import CanvasBoard from "./CanvasBoard.js";
 import Menu from "./Menu.js";
 import storage from "../storage.js";
 import soko from "../soko.js";
+import solver from "../solver.js";
 
 
 /**
@@ -16,6 +18,9 @@ const Level = {
         <button title="Reset (r)" id="reset">
           <span class="material-symbols-outlined">refresh</span>
         </button>
+        <button title="Hint (h)" id="hint">
+          <span class="material-symbols-outlined">lightbulb</span>
+        </button>
         <button title="Change Level" id="change-level">
           <span class="material-symbols-outlined">home</span>
         </button>
@@ -25,6 +30,13 @@ const Level = {
     </div>
   `,
 
+  /**
+   * Boards with more cells than this are drawn on a canvas; the table
+   * gets slow to build and lay out past it. ?renderer=canvas or
+   * ?renderer=table in the URL picks one for every board.
+  */
+  canvasCells: 2500,
+
   cellToClass: {
     "_": "floor-outside",
     " ": "floor",
@@ -41,7 +53,7 @@ const Level = {
    * @param HTMLElement root the root element to render into
    * @param number levelNumber the level to play
   */
-  render(root, levelNumber) {
+  async render(root, levelNumber) {
     root.innerHTML = this.html;
     document
       .querySelector("#change-level")
@@ -56,12 +68,32 @@ const Level = {
       return;
     }
 
+    // The level's cells may still have to be fetched, and another level
+    // or the menu may have been rendered in the meantime
+    const gameEl = document.getElementById("game");
+
+    if (!await soko.loadLevel(levelNumber)) {
+      location.hash = "";
+      return;
+    }
+
+    if (!gameEl.isConnected) {
+      return;
+    }
+
     soko.changeLevel(levelNumber);
 
     const boardEl = document.getElementById("board");
     const undoEl = document.getElementById("undo");
     const resetEl = document.getElementById("reset");
+    const hintEl = document.getElementById("hint");
     const statusEl = document.querySelector("#status");
+    const renderer = new URLSearchParams(location.search).get("renderer");
+    const [firstRow, ...rows] = soko.boardToStr().split("\n");
+    const cells = rows.reduce((n, row) => n + row.length, firstRow.length);
+    const canvas = renderer ? renderer === "canvas" :
+      cells > this.canvasCells;
+    const canvasBoard = canvas ? CanvasBoard.create(boardEl) : null;
 
     /**
      * Maps a row to its HTML string
@@ -84,20 +116,29 @@ const Level = {
 
     let outsideTiles = null;
 
+    // The board's cells by row and column, for redrawing single cells
+    let cellEls = [];
+
     /**
      * This function detects which floor tiles are outside of the walls.
      * Mutates outsideTiles for performance purposes.
      * @param string[] board the board to detect tiles on
     */
     const detectOutsideTiles = board => {
+      // With a stack of its own, since large boards recurse too deep
       const flood = (board, row, col) => {
-        if (board[row] && board[row][col] === " ") {
-          board[row][col] = "_";
-          outsideTiles.push([row, col]);
-          flood(board, row - 1, col);
-          flood(board, row + 1, col);
-          flood(board, row, col - 1);
-          flood(board, row, col + 1);
+        const stack = [[row, col]];
+
+        while (stack.length) {
+          const [row, col] = stack.pop();
+
+          if (board[row] && board[row][col] === " ") {
+            board[row][col] = "_";
+            outsideTiles.push([row, col]);
+            stack.push(
+              [row - 1, col], [row + 1, col], [row, col - 1], [row, col + 1]
+            );
+          }
         }
       };
 
@@ -144,11 +185,17 @@ const Level = {
         detectOutsideTiles(board);
       }
 
+      if (canvasBoard) {
+        canvasBoard.draw(board);
+        return;
+      }
+
       boardEl.innerHTML = `
         <table><tbody>
           ${board.map(buildRowHTML).join("")}
         </tbody></table>
       `;
+      cellEls = [...boardEl.querySelectorAll("tr")].map(row => row.children);
     };
 
     /**
@@ -156,23 +203,111 @@ const Level = {
     */
     const renderStatusBar = () => {
       statusEl.innerHTML = `
-        <div>Moves: ${soko.sequence().length}</div>
+        <div>Moves: ${soko.moves()}</div>
       `;
     };
 
     /**
-     * Perform a full rerender of the game board, including status bar
+     * Renders the status bar and the controls that depend on the moves
     */
-    const render = () => {
-      renderBoard();
+    const renderStatus = () => {
       renderStatusBar();
-      undoEl.disabled = resetEl.disabled = soko.sequence().length === 0;
+      undoEl.disabled = resetEl.disabled = soko.moves() === 0;
 
       if (document.activeElement) {
         document.activeElement.blur();
       }
     };
 
+    /**
+     * Perform a full rerender of the game board, including status bar
+    */
+    const render = () => {
+      renderBoard();
+      renderStatus();
+    };
+
+    /**
+     * Redraws only the cells a batch of moves changed
+     * @param Array changes {row, col, cell} for each changed cell
+    */
+    const renderChanges = changes => {
+      if (canvasBoard) {
+        canvasBoard.update(changes);
+      }
+      else {
+        for (const {row, col, cell} of changes) {
+          cellEls[row][col].className = `cell ${this.cellToClass[cell]}`;
+        }
+      }
+
+      renderStatus();
+    };
+
+    // Moves queued by key presses since the last frame
+    let queued = "";
+    let frame = null;
+
+    /**
+     * Makes the queued moves in one engine call and draws their changes,
+     * so held or mashed keys cost one render per frame however fast they
+     * repeat. Anything else that changes the game flushes first, so it
+     * sees the moves in the order they were pressed.
+    */
+    const flushMoves = () => {
+      cancelAnimationFrame(frame);
+      frame = null;
+
+      if (!queued || !boardEl.isConnected) {
+        queued = "";
+        return;
+      }
+
+      const changes = soko.moveBatch(queued);
+      queued = "";
+
+      if (changes.length) {
+        renderChanges(changes);
+
+        if (soko.solved()) {
+          handleLevelCompleted();
+        }
+      }
+    };
+
+    let hintRequest = null;
+
+    /**
+     * Asks the worker for the next move and shows it in the status bar,
+     * unless the player has moved on by the time it arrives. Play carries
+     * on while the worker searches.
+    */
+    const showHint = () => {
+      if (soko.solved()) {
+        return;
+      }
+
+      if (hintRequest) {
+        hintRequest.abort();
+      }
+
+      const request = hintRequest = new AbortController();
+      const board = soko.boardToStr();
+      statusEl.textContent = "Thinking...";
+      solver.hint(levelNumber, board, {signal: request.signal})
+        .then(move => {
+          if (soko.boardToStr() === board && !request.signal.aborted) {
+            statusEl.textContent = move ? `Hint: ${move}` : "No hint found";
+          }
+        })
+        .catch(err => {
+          if (err.name !== "AbortError") {
+            statusEl.textContent = "No hint found";
+          }
+        })
+      ;
+    };
+
     // Converts event.code to a Sokoban Direction string
     const moves = {
       KeyA: "L",
@@ -191,22 +326,28 @@ const Level = {
         }
 
         event.preventDefault();
+        queued += moves[event.code];
 
-        if (soko.move(moves[event.code])) {
-          render();
-
-          if (soko.solved()) {
-            handleLevelCompleted();
-          }
+        if (frame === null) {
+          frame = requestAnimationFrame(flushMoves);
         }
       }
-      else if (event.code === "KeyZ" && soko.undo()) {
-        render();
+      else if (event.code === "KeyZ") {
+        flushMoves();
+
+        if (soko.undo()) {
+          render();
+        }
       }
       else if (event.code === "KeyR") {
+        flushMoves();
         soko.reset();
         render();
       }
+      else if (event.code === "KeyH") {
+        flushMoves();
+        showHint();
+      }
     };
 
     /**
@@ -214,22 +355,26 @@ const Level = {
      * victory message and saving the best score
     */
     const handleLevelCompleted = () => {
-      statusEl.textContent = `Solved in ${soko.sequence().length} moves`;
-      storage.saveBestScore(levelNumber, soko.sequence().length);
+      statusEl.textContent = `Solved in ${soko.moves()} moves`;
+      storage.saveBestScore(levelNumber, soko.moves());
     };
 
     /**
      * Handler for mouse click events on the board, triggering a long move
     */
     boardEl.addEventListener("click", event => {
-      const cell = event.target.closest("td");
+      const td = event.target.closest("td");
+      const cell = canvasBoard ? canvasBoard.cellAt(event) : td && {
+        row: +td.getAttribute("data-row"),
+        col: +td.getAttribute("data-col"),
+      };
 
-      if (soko.solved() || !cell || !boardEl.contains(cell)) {
+      if (soko.solved() || !cell || (td && !boardEl.contains(td))) {
         return;
       }
- 
-      const row = +cell.getAttribute("data-row");
-      const col = +cell.getAttribute("data-col");
+
+      const {row, col} = cell;
+      flushMoves();
  
       if (soko.goto(row, col)) {
         render();
@@ -244,15 +389,26 @@ const Level = {
      * Handler for click events on the undo button
     */
     undoEl.addEventListener("click", event => {
+      flushMoves();
+
       if (soko.undo()) {
         render();
       }
     });
 
+    /**
+     * Handler for click events on the hint button
+    */
+    hintEl.addEventListener("click", () => {
+      flushMoves();
+      showHint();
+    });
+
     /**
      * Handler for click events on the reset button
     */
     resetEl.addEventListener("click", event => {
+      flushMoves();
       soko.reset();
       render();
     });
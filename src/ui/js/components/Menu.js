@@ -1,3 +1,4 @@
+import soko from "../soko.js";
 import storage from "../storage.js";
 
 
@@ -13,7 +14,7 @@ const Menu = {
         <em>by Irvin, Juan, Severin & Greg</em>
       </div>
       <ul>
-        ${[...Array(Module.ccall("sokoban_levels_size"))].map((_, i) => `
+        ${[...Array(soko.levelsSize())].map((_, i) => `
           <li>
             <a href="#${i + 1}">
               <span class="material-symbols-outlined">
@@ -1,7 +1,7 @@
 import Level from "./components/Level.js";
 import Loading from "./components/Loading.js";
 import Menu from "./components/Menu.js";
-import soko from "./soko.js";
+import soko, {moduleReady} from "./soko.js";
 
 
 // The root element for the entire single page app
@@ -0,0 +1,10 @@
+/**
+ * Whether this browser runs WebAssembly SIMD, which picks between the
+ * engine's scalar and -msimd128 builds. A classic script, so both the page
+ * and the solver worker can load it. The module is a single function
+ * returning i8x16.popcnt of a splat; engines without SIMD reject it.
+*/
+const simdSupported = WebAssembly.validate(new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1,
+  8, 0, 65, 0, 253, 15, 253, 98, 11,
+]));
@@ -1,38 +1,233 @@
 /**
  * This module provides an interface into the game engine.
  * No methods are available until Emscripten has completed loading.
+ * The engine hosts any number of games; this module plays one of them,
+ * passing its session handle on every call.
 */
 const soko = {};
 
-moduleReady.then(() => {
-  Module.ccall("sokoban_initialize");
+const loadScript = src => new Promise((resolve, reject) => {
+  const script = document.createElement("script");
+  script.src = src;
+  script.onload = resolve;
+  script.onerror = reject;
+  document.body.append(script);
+});
+
+// Sizes of the pack's header and of each level's entry in its index; see
+// level_pack.hpp for the layout
+const headerSize = 16;
+const entrySize = 24;
+
+/**
+ * Fetch a range of the level pack's bytes
+ * @param number start the first byte
+ * @param number end the last byte, or the end of the pack if omitted
+ * @return Promise<{bytes, whole}> the bytes, null if there are none, and
+ * whether the server ignored the range and sent the whole pack
+*/
+const fetchPack = (start, end = "") => fetch("levels.pack", {
+  headers: {Range: `bytes=${start}-${end}`},
+}).then(async response => ({
+  bytes: response.ok ? new Uint8Array(await response.arrayBuffer()) : null,
+  whole: response.status === 200,
+}));
+
+// Only the pack's header, index and metadata download up front, while the
+// engine compiles; each level's cells are fetched the first time it's
+// played. A server that ignores ranges sends the whole pack at once.
+// Embedded builds have no pack.
+const levelPack = fetchPack(0, headerSize - 1).then(async head => {
+  if (!head.bytes || head.whole) {
+    return head.bytes && {...head, count: 0};
+  }
+
+  const view = new DataView(head.bytes.buffer);
+  const count = view.getUint32(8, true);
+  const strings = view.getUint32(12, true);
+  const [index, tail] = await Promise.all([
+    count ? fetchPack(headerSize, headerSize + entrySize * count - 1) : {},
+    fetchPack(strings),
+  ]);
+
+  // The cells in between stay zero until sokoban_fill_level() copies in
+  // each level's
+  const bytes = new Uint8Array(strings + (tail.bytes ? tail.bytes.length : 0));
+  bytes.set(head.bytes);
+  bytes.set(index.bytes || [], headerSize);
+  bytes.set(tail.bytes || [], strings);
+  return {bytes, whole: false, count};
+}).catch(() => null);
+
+/**
+ * Resolves when the engine is loaded and every method is available. The
+ * SIMD build is loaded where the browser can run it.
+*/
+export const moduleReady = loadScript(
+  simdSupported ? "sokoban_simd.js" : "sokoban.js"
+).then(() => createSokoban({
+  print: text => console.log(text),
+  printErr: text => console.error(text),
+})).then(async Module => {
+  const pack = await levelPack;
+
+  if (pack) {
+    Module.FS.writeFile("levels.pack", pack.bytes);
+  }
+
+  Module.ccall(
+    "sokoban_initialize",
+    null,
+    ["boolean"],
+    [Boolean(pack && !pack.whole)]
+  );
+  const fillLevel = Module.cwrap(
+    "sokoban_fill_level",
+    "bool",
+    ["number", "array", "number"]
+  );
+  const filled = new Set();
+
+  // Fetch a pack level's cells unless they're already in the engine,
+  // resolving to whether the level can be played
+  const loadLevel = async level => {
+    if (!pack || pack.whole || level >= pack.count || filled.has(level)) {
+      return true;
+    }
+
+    const entry = new DataView(
+      pack.bytes.buffer, headerSize + entrySize * level, entrySize
+    );
+    const offset = entry.getUint32(0, true);
+    const size = Math.ceil(
+      entry.getUint16(4, true) * entry.getUint16(6, true) / 2
+    );
+    const cells = await fetchPack(offset, offset + size - 1)
+      .catch(() => ({}));
+
+    if (!cells.bytes) {
+      return false;
+    }
+
+    const bytes = cells.whole
+      ? cells.bytes.subarray(offset, offset + size)
+      : cells.bytes;
+
+    if (fillLevel(level, bytes, bytes.length)) {
+      filled.add(level);
+    }
+
+    return filled.has(level);
+  };
+
+  // A new session starts on the first level
+  await loadLevel(0);
+  const session = Module.ccall("sokoban_create", "number");
+
+  // Bind a session function to this module's session
+  const bind = (name, returnType, argTypes = []) => {
+    const fn = Module.cwrap(name, returnType, ["number", ...argTypes]);
+    return (...args) => fn(session, ...args);
+  };
+
   const methods = {
-    move: Module.cwrap(
+    loadLevel,
+    move: bind(
       "sokoban_move", // name of C function
       "bool",         // return type
-      ["string"],     // argument types
+      ["string"],     // argument types after the session
     ),
-    boardToStr: Module.cwrap(
+    boardToStr: bind(
       "sokoban_board_to_string",
       "string", // return type
     ),
-    changeLevel: Module.cwrap(
+    changeLevel: bind(
       "sokoban_change_level",
       "bool",
       ["number"]
     ),
-    goto: Module.cwrap(
+    goto: bind(
       "sokoban_goto",
       "bool",
       ["number", "number"]
     ),
-    levelNumber: Module.cwrap("sokoban_level"),
+    hint: bind("sokoban_hint", "string"),
+    jump: bind("sokoban_jump", "bool", ["number"]),
+    levelAuthor: Module.cwrap(
+      "sokoban_level_author",
+      "string",
+      ["number"]
+    ),
+    levelNumber: bind("sokoban_level", "number"),
     levelsSize: Module.cwrap("sokoban_levels_size"),
-    reset: Module.cwrap("sokoban_reset"),
-    sequence: Module.cwrap("sokoban_sequence", "string"),
-    solved: Module.cwrap("sokoban_solved", "bool"),
-    undo: Module.cwrap("sokoban_undo", "bool"),
+    levelTitle: Module.cwrap(
+      "sokoban_level_title",
+      "string",
+      ["number"]
+    ),
+    moves: bind("sokoban_moves", "number"),
+    node: bind("sokoban_node", "number"),
+    parent: bind("sokoban_parent", "number", ["number"]),
+    pushes: bind("sokoban_pushes", "number"),
+    reset: bind("sokoban_reset", null),
+    restore: bind("sokoban_deserialize", "bool", ["array", "number"]),
+    save: () => {
+      const blob = Module.ccall(
+        "sokoban_serialize",
+        "number", // pointer into the heap rather than a string
+        ["number"],
+        [session]
+      );
+      const size = Module.ccall(
+        "sokoban_serialized_size",
+        "number",
+        ["number"],
+        [session]
+      );
+      return Module.HEAPU8.slice(blob, blob + size);
+    },
+    sequence: bind("sokoban_sequence", "string"),
+    solved: bind("sokoban_solved", "bool"),
+    undo: bind("sokoban_undo", "bool"),
+  };
+  const variation = bind("sokoban_variation", "number", ["number", "number"]);
+
+  // The first node of each line played from a node, oldest first
+  methods.variations = node => {
+    const nodes = [];
+    let child = variation(node, 0);
+
+    while (child) {
+      nodes.push(child);
+      child = variation(node, nodes.length);
+    }
+
+    return nodes;
   };
+  const moveBatch = bind("sokoban_move_batch", "number", ["string"]);
+  const changes = bind("sokoban_changes", "number");
+
+  // Make queued moves in one call, returning {row, col, cell} for each
+  // cell they changed; none if no move was made
+  methods.moveBatch = directions => {
+    const count = moveBatch(directions);
+    const cells = new Int32Array(Module.HEAPU8.buffer, changes(), count * 3);
+    return [...Array(count)].map((_, i) => ({
+      row: cells[i * 3],
+      col: cells[i * 3 + 1],
+      cell: String.fromCharCode(cells[i * 3 + 2]),
+    }));
+  };
+  const stats = bind("sokoban_stats", "string");
+  const traceStop = Module.cwrap("sokoban_trace_stop", "string");
+
+  // The engine's counters, zeros unless built with --stats
+  methods.stats = () => JSON.parse(stats());
+
+  // Record level loads and walks until traceStop(), which returns them as
+  // a Chrome trace to open in Perfetto; empty unless built with --stats
+  methods.traceStart = Module.cwrap("sokoban_trace_start", null);
+  methods.traceStop = () => JSON.parse(traceStop());
   Object.assign(soko, methods);
 });
 
@@ -0,0 +1,129 @@
+/**
+ * A promise-based interface to the engine's expensive searches. They run
+ * in a Web Worker on a second build of the engine, so the game in soko.js
+ * keeps answering moves while a search is going. The worker is started on
+ * first use.
+*/
+let worker = null;
+let nextId = 0;
+const pending = new Map();
+
+const abortError = () => new DOMException("The search was cancelled",
+  "AbortError");
+
+const handleMessage = ({data}) => {
+  const request = pending.get(data.id);
+
+  if (!request) {
+    return;
+  }
+
+  if (data.type === "progress") {
+    if (request.onProgress) {
+      request.onProgress({nodes: data.nodes, bound: data.bound});
+    }
+
+    return;
+  }
+
+  pending.delete(data.id);
+
+  if (data.type === "result") {
+    request.resolve(data.result);
+  }
+  else {
+    request.reject(new Error(data.message));
+  }
+};
+
+/**
+ * Send a request to the worker
+ * @param object message the request, with its type and arguments
+ * @param object options onProgress, called with {nodes, bound}, and signal,
+ * an AbortSignal that cancels the request
+ * @return Promise the request's result
+*/
+const request = (message, {onProgress, signal} = {}) =>
+  new Promise((resolve, reject) => {
+    if (signal && signal.aborted) {
+      reject(abortError());
+      return;
+    }
+
+    if (!worker) {
+      worker = new Worker("js/solverWorker.js");
+      worker.onmessage = handleMessage;
+    }
+
+    const id = nextId++;
+    pending.set(id, {resolve, reject, onProgress});
+
+    if (signal) {
+      signal.addEventListener("abort", () => {
+        if (pending.delete(id)) {
+          worker.postMessage({id, type: "cancel"});
+          reject(abortError());
+        }
+      }, {once: true});
+    }
+
+    worker.postMessage({...message, id});
+  });
+
+const solver = {
+  /**
+   * Solve a board. The search is cancelled between slices of its node
+   * budget, so cancelling frees the worker almost immediately.
+   * @param string board the rows joined by newlines, as from
+   * soko.boardToStr()
+   * @param object options weight, the heuristic weight (1 for an optimal
+   * solution); first, to stop at the first solution; slice, the nodes
+   * searched between progress events; threads, at most the number from
+   * info(), which is the default; onProgress and signal as above
+   * @return Promise {status, solution, optimal, nodes, times}, where
+   * status is "solved" or "unsolvable" and times holds the milliseconds
+   * spent in each search phase, zeros unless built with --stats
+  */
+  solve: (board, options = {}) => {
+    const {weight = 1, first = false, slice, threads, ...hooks} = options;
+    const message = {type: "solve", board, weight, first, slice, threads};
+    return request(message, hooks);
+  },
+
+  /**
+   * Describe the build the worker loaded
+   * @return Promise {threads, simd}: the most threads a solve can use, 1
+   * unless the page is cross-origin isolated and the threaded build exists,
+   * and whether it's the SIMD variant
+  */
+  info: () => request({type: "info"}),
+
+  /**
+   * Find the next move towards solving a board. A hint that is already
+   * searching can't stop early, but cancelling one still settles its
+   * promise at once and drops the answer.
+   * @param number level the level the board is from, which keys the
+   * worker's cached solution
+   * @param string board the rows joined by newlines
+   * @param object options signal as above
+   * @return Promise the LURD move, or "" when solved or none was found
+  */
+  hint: (level, board, options) =>
+    request({type: "hint", level, board}, options),
+
+  /**
+   * Start recording the worker's searches as trace events, discarding any
+   * earlier trace. Only builds made with --stats record anything.
+   * @return Promise settled once recording has started
+  */
+  traceStart: () => request({type: "traceStart"}),
+
+  /**
+   * Stop recording
+   * @return Promise the Chrome trace-event object, to save as JSON and
+   * open in Perfetto or about:tracing
+  */
+  traceStop: () => request({type: "traceStop"}),
+};
+
+export default solver;
@@ -0,0 +1,157 @@
+/**
+ * Runs the worker build of the engine off the main thread. Each request
+ * carries an id that its progress and result messages echo. A solve runs
+ * in slices of a node budget and yields between them, so progress is
+ * posted as it goes and a cancel message is seen within one slice.
+ * Requests run one at a time in the order they arrive.
+ *
+ * On a cross-origin isolated page the threaded build is loaded if it was
+ * built, and solves use a thread per core; otherwise the single-threaded
+ * build runs them serially. Either is the SIMD variant where the browser
+ * supports it.
+*/
+importScripts("simd.js");
+const suffix = simdSupported ? "_simd" : "";
+
+const load = script => {
+  const ready = new Promise(resolve => {
+    self.Module = {
+      // The worker lives in js/, beside none of the build's files
+      locateFile: file => `../${file}`,
+
+      // pthreads are workers running the build's script, not this one
+      mainScriptUrlOrBlob: `../${script}`,
+      postRun: [resolve],
+    };
+  });
+
+  // Throws if the script doesn't exist
+  importScripts(`../${script}`);
+  return ready;
+};
+
+const loadEngine = () => {
+  if (self.crossOriginIsolated) {
+    try {
+      return {
+        ready: load(`sokoban_worker_threads${suffix}.js`),
+        threads: navigator.hardwareConcurrency || 1,
+      };
+    }
+    catch (err) {
+      // Not built with --threads
+    }
+  }
+
+  return {ready: load(`sokoban_worker${suffix}.js`), threads: 1};
+};
+
+const {ready: moduleReady, threads} = loadEngine();
+
+// Solver::Status values, in enum order
+const statuses = ["solved", "unsolvable", "budget-exhausted", "cancelled"];
+const BUDGET_EXHAUSTED = 2;
+const CANCELLED = 3;
+
+const cancelled = new Set();
+let handlers = {};
+let queue = moduleReady;
+
+moduleReady.then(() => {
+  const engine = {
+    start: Module.cwrap(
+      "solver_start",
+      "bool",
+      ["string", "number", "bool", "number"]
+    ),
+    run: Module.cwrap("solver_run", "number", ["number"]),
+    nodes: Module.cwrap("solver_nodes", "number"),
+    bound: Module.cwrap("solver_bound", "number"),
+    optimal: Module.cwrap("solver_optimal", "bool"),
+    solution: Module.cwrap("solver_solution", "string"),
+    stats: Module.cwrap("solver_stats", "string"),
+    stop: Module.cwrap("solver_stop", null),
+    traceStart: Module.cwrap("solver_trace_start", null),
+    traceStop: Module.cwrap("solver_trace_stop", "string"),
+    hint: Module.cwrap("worker_hint", "string", ["number", "string"]),
+  };
+
+  // Let waiting messages, such as a cancel, in before the next slice
+  const yieldToMessages = () => new Promise(resolve => setTimeout(resolve));
+
+  const finish = status => {
+    const result = {
+      status: statuses[status],
+      solution: engine.solution(),
+      optimal: engine.optimal(),
+      nodes: engine.nodes(),
+      // Milliseconds per search phase, zeros unless built with --stats
+      times: JSON.parse(engine.stats()),
+    };
+    engine.stop();
+    return result;
+  };
+
+  handlers = {
+    async solve({
+      id,
+      board,
+      weight = 1,
+      first = false,
+      slice = 20000,
+      threads: requested = threads,
+    }) {
+      const count = Math.max(1, Math.min(requested, threads));
+
+      if (!engine.start(board, weight, first, count)) {
+        throw new Error("The board can't be solved as given");
+      }
+
+      let status = engine.run(slice);
+
+      while (status === BUDGET_EXHAUSTED) {
+        self.postMessage({
+          id,
+          type: "progress",
+          nodes: engine.nodes(),
+          bound: engine.bound(),
+        });
+        await yieldToMessages();
+
+        if (cancelled.delete(id)) {
+          return finish(CANCELLED);
+        }
+
+        status = engine.run(slice);
+      }
+
+      return finish(status);
+    },
+    hint: ({level, board}) => engine.hint(level, board),
+    info: () => ({threads, simd: simdSupported}),
+    traceStart: () => engine.traceStart(),
+    traceStop: () => JSON.parse(engine.traceStop()),
+  };
+});
+
+self.onmessage = ({data}) => {
+  if (data.type === "cancel") {
+    cancelled.add(data.id);
+    return;
+  }
+
+  queue = queue.then(async () => {
+    if (cancelled.delete(data.id)) {
+      self.postMessage({id: data.id, type: "error", message: "Cancelled"});
+      return;
+    }
+
+    try {
+      const result = await handlers[data.type](data);
+      self.postMessage({id: data.id, type: "result", result});
+    }
+    catch (err) {
+      self.postMessage({id: data.id, type: "error", message: err.message});
+    }
+  });
+};
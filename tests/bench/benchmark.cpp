@@ -0,0 +1,189 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <stdexcept>
+
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+bool counting = false;
+unsigned long allocations = 0;
+unsigned long allocated = 0;
+
+// Heap bytes held now, when reset_peak() was last called and at most
+// since then, as malloc sizes them
+unsigned long live = 0;
+unsigned long base = 0;
+unsigned long peak = 0;
+
+/**
+ * Read the number after "key": on a line of write_json()'s output
+*/
+double field(const std::string &line, const std::string &key) {
+    const size_t at = line.find("\"" + key + "\":");
+
+    if (at == std::string::npos) {
+        throw std::invalid_argument("Missing " + key + " in " + line);
+    }
+
+    return std::stod(line.substr(at + key.size() + 3));
+}
+
+/**
+ * The bytes malloc set aside for a block, which may be more than were
+ * asked for; each platform names this differently
+*/
+size_t usable_size(void *p) {
+#if defined(_WIN32)
+    return p ? _msize(p) : 0;
+#elif defined(__APPLE__)
+    return p ? malloc_size(p) : 0;
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    if (counting) {
+        allocations++;
+        allocated += size;
+    }
+
+    if (void *p = std::malloc(size ? size : 1)) {
+        live += usable_size(p);
+        peak = std::max(peak, live);
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    live -= usable_size(p);
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+double Benchmark::Result::ns_per_op() const {
+    return ops ? ns / ops : 0;
+}
+
+double Benchmark::Result::allocs_per_op() const {
+    return ops ? (double) allocs / ops : 0;
+}
+
+double Benchmark::Result::bytes_per_op() const {
+    return ops ? (double) bytes / ops : 0;
+}
+
+void Benchmark::run(Result &result, const std::function<void()> &setup,
+                    const std::function<void()> &op, unsigned int batch,
+                    std::chrono::nanoseconds min_time) {
+    std::chrono::nanoseconds spent(0);
+
+    while (spent < min_time) {
+        setup();
+        const unsigned long allocs = allocations;
+        const unsigned long bytes = allocated;
+        counting = true;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int i = 0; i < batch; i++) {
+            op();
+        }
+
+        spent += std::chrono::steady_clock::now() - start;
+        counting = false;
+        result.ops += batch;
+        result.allocs += allocations - allocs;
+        result.bytes += allocated - bytes;
+    }
+
+    result.ns += spent.count();
+}
+
+void Benchmark::reset_peak() {
+    base = live;
+    peak = live;
+}
+
+unsigned long Benchmark::peak_bytes() {
+    return peak - base;
+}
+
+void Benchmark::write_json(const std::string &path,
+                           const std::vector<Result> &results) {
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(2) << "{\"benchmarks\": [\n";
+
+    for (unsigned int i = 0; i < results.size(); i++) {
+        const Result &result = results[i];
+        out << "  {\"name\": \"" << result.name << "\", "
+            << "\"ops\": " << result.ops << ", "
+            << "\"ns_per_op\": " << result.ns_per_op() << ", "
+            << "\"allocs_per_op\": " << result.allocs_per_op() << ", "
+            << "\"bytes_per_op\": " << result.bytes_per_op() << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "]}\n";
+
+    if (!out) {
+        throw std::invalid_argument("Unable to write " + path);
+    }
+}
+
+std::vector<Benchmark::Result> Benchmark::read_json(const std::string &path) {
+    std::ifstream in(path);
+
+    if (!in) {
+        throw std::invalid_argument("Unable to read " + path);
+    }
+
+    std::vector<Result> results;
+
+    for (std::string line; std::getline(in, line);) {
+        const size_t name = line.find("\"name\": \"");
+
+        if (name == std::string::npos) {
+            continue;
+        }
+
+        Result result;
+        const size_t start = name + 9;
+        result.name = line.substr(start, line.find('"', start) - start);
+        result.ops = 1;
+        result.ns = field(line, "ns_per_op");
+        result.allocs = field(line, "allocs_per_op");
+        result.bytes = field(line, "bytes_per_op");
+        results.push_back(result);
+    }
+
+    return results;
+}
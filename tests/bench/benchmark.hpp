@@ -0,0 +1,70 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Times an operation and counts the heap allocations it makes. The
+ * operation runs in batches, each after an untimed setup, until it has run
+ * for a minimum time; totals accumulate in a Result so one benchmark can
+ * span many levels. Allocations are counted by replacing the global
+ * operator new, only while a batch runs; the same replacement tracks the
+ * heap's peak for measuring memory use.
+*/
+class Benchmark {
+public:
+    struct Result {
+        std::string name;
+        unsigned long ops = 0;
+        double ns = 0;
+        double allocs = 0;
+        double bytes = 0;
+
+        double ns_per_op() const;
+        double allocs_per_op() const;
+        double bytes_per_op() const;
+    };
+
+    /**
+     * Run an operation until it has taken at least min_time
+     * @param Result result the totals to add to
+     * @param std::function setup run untimed before each batch
+     * @param std::function op the operation
+     * @param unsigned int batch the calls to op after each setup
+     * @param std::chrono::nanoseconds min_time the time to spend in op
+    */
+    static void run(Result &result, const std::function<void()> &setup,
+                    const std::function<void()> &op, unsigned int batch,
+                    std::chrono::nanoseconds min_time);
+
+    /**
+     * Start measuring the heap's peak from the bytes held now
+    */
+    static void reset_peak();
+
+    /**
+     * @return unsigned long the most heap bytes held at once since
+     * reset_peak(), over what was held then
+    */
+    static unsigned long peak_bytes();
+
+    /**
+     * Write results as a JSON object with one benchmark per line
+     * @param std::string path the file to write
+     * @param std::vector<Result> results the results
+    */
+    static void write_json(const std::string &path,
+                           const std::vector<Result> &results);
+
+    /**
+     * Read results that write_json() wrote
+     * @param std::string path the file to read
+     * @return std::vector<Result> the results, with per-op figures scaled
+     * to one op
+    */
+    static std::vector<Result> read_json(const std::string &path);
+};
+#endif
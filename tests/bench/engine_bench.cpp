@@ -0,0 +1,301 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "../../src/engine/level_parser.hpp"
+#include "../../src/engine/level_store.hpp"
+#include "../../src/engine/sokoban.hpp"
+
+using Cell = std::pair<unsigned int, unsigned int>;
+
+// Results are read here so the compiler can't drop the calls
+static volatile unsigned long sink;
+
+static const unsigned int batch = 1000;
+
+static Cell find_player(const std::vector<std::string> &board) {
+    for (unsigned int y = 0; y < board.size(); y++) {
+        const size_t x = board[y].find_first_of("@+");
+
+        if (x != std::string::npos) {
+            return {y, x};
+        }
+    }
+
+    throw std::invalid_argument("No player on the board");
+}
+
+/**
+ * Find the floor cell the player can walk to in the most steps, around
+ * the boxes
+*/
+static Cell farthest(const std::vector<std::string> &board) {
+    std::vector<std::vector<bool>> seen(board.size());
+
+    for (unsigned int y = 0; y < board.size(); y++) {
+        seen[y].resize(board[y].size());
+    }
+
+    const Cell start = find_player(board);
+    std::queue<Cell> queue;
+    queue.push(start);
+    seen[start.first][start.second] = true;
+    Cell last = start;
+
+    while (!queue.empty()) {
+        last = queue.front();
+        queue.pop();
+        const auto [y, x] = last;
+
+        for (const Cell &next : {Cell(y - 1, x), Cell(y + 1, x),
+                                Cell(y, x - 1), Cell(y, x + 1)}) {
+            const auto [ny, nx] = next;
+
+            if (ny < board.size() && nx < board[ny].size() &&
+                    !seen[ny][nx] && std::strchr(" .", board[ny][nx])) {
+                seen[ny][nx] = true;
+                queue.push(next);
+            }
+        }
+    }
+
+    return last;
+}
+
+/**
+ * Find a direction the player can step in without pushing, and its
+ * opposite, so stepping back and forth never blocks
+ * @return the directions, or none if every first move is a push
+*/
+static std::optional<std::pair<Sokoban::Direction, Sokoban::Direction>>
+free_step(const std::vector<std::string> &board) {
+    const auto [y, x] = find_player(board);
+    const std::pair<Sokoban::Direction, Sokoban::Direction> steps[] = {
+        {Sokoban::U, Sokoban::D}, {Sokoban::D, Sokoban::U},
+        {Sokoban::L, Sokoban::R}, {Sokoban::R, Sokoban::L},
+    };
+    const Cell cells[] = {{y - 1, x}, {y + 1, x}, {y, x - 1}, {y, x + 1}};
+
+    for (unsigned int i = 0; i < 4; i++) {
+        if (std::strchr(" .", board[cells[i].first][cells[i].second])) {
+            return steps[i];
+        }
+    }
+
+    return std::nullopt;
+}
+
+static void usage(const char *program) {
+    std::cerr << "usage: " << program << " [--levels dir] [--time ms]"
+        << " [--json file] [--baseline file] [--threshold percent]\n";
+}
+
+int main(int argc, char **argv) {
+    std::string directory = "../../src/engine/levels";
+    std::string json;
+    std::string baseline;
+    double threshold = 15;
+    std::chrono::milliseconds per_level(5);
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+
+        if (option == "--levels") {
+            directory = argv[i + 1];
+        }
+        else if (option == "--time") {
+            per_level = std::chrono::milliseconds(std::stoi(argv[i + 1]));
+        }
+        else if (option == "--json") {
+            json = argv[i + 1];
+        }
+        else if (option == "--baseline") {
+            baseline = argv[i + 1];
+        }
+        else if (option == "--threshold") {
+            threshold = std::stod(argv[i + 1]);
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (argc % 2 == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::vector<std::string>> boards;
+
+    for (const Level &level : LevelParser::read_directory(directory, 1)) {
+        boards.push_back(level.board);
+    }
+
+    // Most levels start with the player penned in by boxes, so the moves
+    // are timed on each level with its boxes taken off, where a walk can
+    // cross the whole level
+    std::vector<std::vector<std::string>> open = boards;
+
+    for (std::vector<std::string> &board : open) {
+        for (std::string &row : board) {
+            for (char &cell : row) {
+                if (cell == '$') {
+                    cell = ' ';
+                }
+                else if (cell == '*') {
+                    cell = '.';
+                }
+            }
+        }
+    }
+
+    Sokoban soko(std::make_shared<const LevelStore>(boards));
+    Sokoban walker(std::make_shared<const LevelStore>(open));
+    std::vector<Benchmark::Result> results;
+    auto result = [&](const std::string &name) -> Benchmark::Result & {
+        for (Benchmark::Result &result : results) {
+            if (result.name == name) {
+                return result;
+            }
+        }
+
+        results.push_back({name});
+        return results.back();
+    };
+
+    for (unsigned int level = 0; level < boards.size(); level++) {
+        const auto free = free_step(open[level]);
+        const auto [there, back] = free.value_or(
+            std::make_pair(Sokoban::U, Sokoban::D)
+        );
+        const auto [py, px] = find_player(open[level]);
+        const auto [fy, fx] = farthest(open[level]);
+        unsigned int i = 0;
+
+        // The node a batch of walks ended on, to replay them without the
+        // searches once they've been made
+        unsigned int walked = 0;
+
+        // Steps back and forth, or walks between the far cells, a batch
+        // at a time from the level's start
+        auto start = [&]() {
+            soko.change_level(level);
+            walker.change_level(level);
+            i = 0;
+            walked = 0;
+        };
+        auto step = [&]() {
+            sink += walker.move(i++ % 2 ? back : there);
+        };
+        auto walk = [&]() {
+            sink += i++ % 2 ? walker.move(py, px) : walker.move(fy, fx);
+        };
+        auto steps = [&]() {
+            start();
+
+            for (unsigned int j = 0; j < batch; j++) {
+                step();
+            }
+        };
+        auto walks = [&]() {
+            if (walked) {
+                walker.jump(walked);
+                return;
+            }
+
+            start();
+
+            for (unsigned int j = 0; j < batch; j++) {
+                walk();
+            }
+
+            walked = walker.node();
+        };
+
+        // A player walled in on three sides has no steps to repeat
+        if (free) {
+            Benchmark::run(result("move"), start, step, batch, per_level);
+            Benchmark::run(result("undo"), steps, [&]() {
+                sink += walker.undo();
+            }, batch, per_level);
+            Benchmark::run(result("redo"), [&]() {
+                steps();
+
+                while (walker.undo()) {
+                }
+            }, [&]() {
+                sink += walker.redo();
+            }, batch, per_level);
+        }
+
+        Benchmark::run(result("rewind"), walks, [&]() {
+            sink += walker.rewind();
+        }, batch, per_level);
+        Benchmark::run(result("move(y, x)"), start, walk, batch, per_level);
+        Benchmark::run(result("solved"), start, [&]() {
+            sink += soko.solved();
+        }, batch, per_level);
+        Benchmark::run(result("board"), start, [&]() {
+            sink += soko.board().size();
+        }, batch, per_level);
+        Benchmark::run(result("change_level"), []() {}, [&]() {
+            soko.change_level(level);
+        }, batch, per_level);
+    }
+
+    std::vector<Benchmark::Result> before;
+
+    if (!baseline.empty()) {
+        before = Benchmark::read_json(baseline);
+    }
+
+    std::cout << "Engine benchmarks over " << boards.size() << " levels\n"
+        << std::left << std::setw(14) << "" << std::right
+        << std::setw(12) << "ns/op" << std::setw(12) << "allocs/op"
+        << std::setw(12) << "bytes/op"
+        << (before.empty() ? "" : "    baseline ns/op    change") << '\n'
+        << std::fixed << std::setprecision(1);
+    bool regressed = false;
+
+    for (const Benchmark::Result &now : results) {
+        std::cout << std::left << std::setw(14) << now.name << std::right
+            << std::setw(12) << now.ns_per_op()
+            << std::setw(12) << now.allocs_per_op()
+            << std::setw(12) << now.bytes_per_op();
+
+        for (const Benchmark::Result &then : before) {
+            if (then.name != now.name) {
+                continue;
+            }
+
+            // Allocations are exact, so any more than the baseline is a
+            // regression; time is noisy, so it gets the threshold
+            const double change =
+                100 * (now.ns_per_op() / then.ns_per_op() - 1);
+            const bool slower = change > threshold ||
+                now.allocs_per_op() > then.allocs_per_op() + 0.005;
+            regressed = regressed || slower;
+            std::cout << std::setw(18) << then.ns_per_op()
+                << std::setw(9) << std::showpos << change << '%'
+                << std::noshowpos << (slower ? "  REGRESSION" : "");
+        }
+
+        std::cout << '\n';
+    }
+
+    if (!json.empty()) {
+        Benchmark::write_json(json, results);
+    }
+
+    return regressed ? 1 : 0;
+}
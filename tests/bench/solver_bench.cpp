@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "../../src/engine/external_solver.hpp"
+#include "../../src/engine/level_parser.hpp"
+#include "../../src/engine/solver.hpp"
+#include "../../src/engine/trace.hpp"
+
+/**
+ * What one search of one level did
+*/
+struct Run {
+    std::string level;
+    std::string status;
+    bool optimal = false;
+    unsigned int pushes = 0;
+    unsigned int moves = 0;
+    unsigned long nodes = 0;
+    double ms = 0;
+    unsigned long peak_bytes = 0;
+
+    double nodes_per_s() const {
+        return ms > 0 ? nodes / ms * 1000 : 0;
+    }
+};
+
+static const char *status_names[] = {
+    "solved", "unsolvable", "budget", "cancelled"
+};
+
+/**
+ * Read the value after "key": on a line of write_json()'s output, up to
+ * the next comma or brace, without the quotes around a string
+*/
+static std::string field(const std::string &line, const std::string &key) {
+    const size_t at = line.find("\"" + key + "\": ");
+
+    if (at == std::string::npos) {
+        throw std::invalid_argument("Missing " + key + " in " + line);
+    }
+
+    const size_t start = at + key.size() + 4;
+    std::string value = line.substr(
+        start, line.find_first_of(",}", start) - start
+    );
+
+    if (value.size() > 1 && value.front() == '"') {
+        value = value.substr(1, value.size() - 2);
+    }
+
+    return value;
+}
+
+/**
+ * Write runs as a JSON object with one level per line
+*/
+static void write_json(const std::string &path, const std::vector<Run> &runs) {
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(2) << "{\"levels\": [\n";
+
+    for (unsigned int i = 0; i < runs.size(); i++) {
+        const Run &run = runs[i];
+        out << "  {\"level\": \"" << run.level << "\", "
+            << "\"status\": \"" << run.status << "\", "
+            << "\"optimal\": " << (run.optimal ? "true" : "false") << ", "
+            << "\"pushes\": " << run.pushes << ", "
+            << "\"moves\": " << run.moves << ", "
+            << "\"nodes\": " << run.nodes << ", "
+            << "\"ms\": " << run.ms << ", "
+            << "\"nodes_per_s\": " << run.nodes_per_s() << ", "
+            << "\"peak_bytes\": " << run.peak_bytes << "}"
+            << (i + 1 < runs.size() ? ",\n" : "\n");
+    }
+
+    out << "]}\n";
+
+    if (!out) {
+        throw std::invalid_argument("Unable to write " + path);
+    }
+}
+
+/**
+ * Read runs that write_json() wrote
+*/
+static std::vector<Run> read_json(const std::string &path) {
+    std::ifstream in(path);
+
+    if (!in) {
+        throw std::invalid_argument("Unable to read " + path);
+    }
+
+    std::vector<Run> runs;
+
+    for (std::string line; std::getline(in, line);) {
+        if (line.find("\"level\": ") == std::string::npos) {
+            continue;
+        }
+
+        Run run;
+        run.level = field(line, "level");
+        run.status = field(line, "status");
+        run.optimal = field(line, "optimal") == "true";
+        run.pushes = std::stoul(field(line, "pushes"));
+        run.moves = std::stoul(field(line, "moves"));
+        run.nodes = std::stoul(field(line, "nodes"));
+        run.ms = std::stod(field(line, "ms"));
+        run.peak_bytes = std::stoul(field(line, "peak_bytes"));
+        runs.push_back(run);
+    }
+
+    return runs;
+}
+
+/**
+ * Write runs as CSV with a header row
+*/
+static void write_csv(const std::string &path, const std::vector<Run> &runs) {
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(2)
+        << "level,status,optimal,pushes,moves,nodes,ms,nodes_per_s,"
+        << "peak_bytes\n";
+
+    for (const Run &run : runs) {
+        out << run.level << ',' << run.status << ','
+            << (run.optimal ? 1 : 0) << ',' << run.pushes << ','
+            << run.moves << ',' << run.nodes << ',' << run.ms << ','
+            << run.nodes_per_s() << ',' << run.peak_bytes << '\n';
+    }
+
+    if (!out) {
+        throw std::invalid_argument("Unable to write " + path);
+    }
+}
+
+/**
+ * Order level names so that numbers sort by value, gri9 before gri10
+*/
+static bool name_order(const std::string &a, const std::string &b) {
+    return a.size() != b.size() ? a.size() < b.size() : a < b;
+}
+
+/**
+ * Read the board of each .xsb file in a directory, in name order
+*/
+static std::vector<std::pair<std::string, std::vector<std::string>>>
+read_levels(const std::string &directory) {
+    std::vector<std::filesystem::path> files;
+
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() == ".xsb") {
+            files.push_back(entry.path());
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const auto &a, const auto &b) {
+        return name_order(a.stem().u8string(), b.stem().u8string());
+    });
+    std::vector<std::pair<std::string, std::vector<std::string>>> levels;
+
+    for (const std::filesystem::path &file : files) {
+        std::ifstream in(file, std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+        levels.push_back(
+            {file.stem().u8string(), LevelParser::parse(text.str()).board}
+        );
+    }
+
+    return levels;
+}
+
+static std::string percent(double before, double after) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << std::showpos
+        << (before ? 100 * (after / before - 1) : 0) << '%';
+    return out.str();
+}
+
+static void usage(const char *program) {
+    std::cerr << "usage: " << program << " [--levels dir] [--nodes n]"
+        << " [--time ms] [--weight w] [--optimal] [--shard i/n]"
+        << " [--merge file...] [--csv file] [--json file]"
+        << " [--baseline file] [--threshold percent] [--trace file]"
+        << " [--external] [--memory MiB] [--spill dir]\n";
+}
+
+int main(int argc, char **argv) {
+    std::string directory = "../../src/engine/levels";
+    std::string csv;
+    std::string json;
+    std::string baseline;
+    std::string trace;
+    std::vector<std::string> merge;
+    double threshold = 15;
+    unsigned int shard = 0;
+    unsigned int shards = 1;
+    Solver::Options options;
+    options.node_limit = 200000;
+    options.weight = 3;
+    options.first = true;
+
+    // --external searches breadth-first on disk instead, which is always
+    // push-optimal and shares only the node and time budgets
+    bool external = false;
+    ExternalSolver::Options on_disk;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        const bool more = i + 1 < argc;
+
+        if (option == "--optimal") {
+            options.first = false;
+        }
+        else if (option == "--external") {
+            external = true;
+        }
+        else if (option == "--merge") {
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                merge.push_back(argv[++i]);
+            }
+        }
+        else if (!more) {
+            usage(argv[0]);
+            return 2;
+        }
+        else if (option == "--levels") {
+            directory = argv[++i];
+        }
+        else if (option == "--nodes") {
+            options.node_limit = std::stoul(argv[++i]);
+        }
+        else if (option == "--time") {
+            options.time_limit = std::chrono::milliseconds(
+                std::stoi(argv[++i])
+            );
+        }
+        else if (option == "--weight") {
+            options.weight = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (option == "--shard") {
+            const std::string value = argv[++i];
+            const size_t slash = value.find('/');
+            shard = std::stoul(value.substr(0, slash));
+            shards = slash == std::string::npos ? 0 :
+                std::stoul(value.substr(slash + 1));
+
+            if (shard >= shards) {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (option == "--csv") {
+            csv = argv[++i];
+        }
+        else if (option == "--json") {
+            json = argv[++i];
+        }
+        else if (option == "--baseline") {
+            baseline = argv[++i];
+        }
+        else if (option == "--threshold") {
+            threshold = std::stod(argv[++i]);
+        }
+        else if (option == "--trace") {
+            trace = argv[++i];
+        }
+        else if (option == "--memory") {
+            on_disk.memory_limit = std::stoul(argv[++i]) << 20;
+        }
+        else if (option == "--spill") {
+            on_disk.directory = argv[++i];
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Run> runs;
+
+    // Shards run in separate processes, each writing its own JSON, and
+    // --merge joins their files without searching again
+    for (const std::string &file : merge) {
+        for (const Run &run : read_json(file)) {
+            runs.push_back(run);
+        }
+    }
+
+    if (!trace.empty()) {
+        if (!instrumented) {
+            std::cerr << "Built without -DSOKOBAN_STATS, so the trace will "
+                << "be empty; rebuild with make STATS=1\n";
+        }
+
+        Trace::start();
+    }
+
+    if (merge.empty()) {
+        const auto levels = read_levels(directory);
+
+        for (unsigned int i = shard; i < levels.size(); i += shards) {
+            const auto &[name, board] = levels[i];
+            Run run{name};
+            Benchmark::reset_peak();
+            const auto start = std::chrono::steady_clock::now();
+
+            try {
+                Solver::Result result;
+
+                if (external) {
+                    on_disk.node_limit = options.node_limit;
+                    on_disk.time_limit = options.time_limit;
+                    result = ExternalSolver(board).solve(on_disk);
+                }
+                else {
+                    result = Solver(board).solve(options);
+                }
+
+                run.status = status_names[result.status];
+                run.optimal = result.optimal;
+                run.nodes = result.nodes;
+
+                if (result.status == Solver::SOLVED) {
+                    run.pushes = result.pushes;
+                    run.moves = result.solution.size();
+                }
+            }
+            catch (const std::invalid_argument &) {
+                run.status = "invalid";
+            }
+
+            const std::chrono::duration<double, std::milli> spent =
+                std::chrono::steady_clock::now() - start;
+            run.ms = spent.count();
+            run.peak_bytes = Benchmark::peak_bytes();
+            runs.push_back(run);
+            std::cerr << name << ' ' << run.status << '\n';
+        }
+    }
+
+    if (!trace.empty()) {
+        Trace::stop();
+        Trace::write(trace);
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const Run &a, const Run &b) {
+        return name_order(a.level, b.level);
+    });
+    std::vector<Run> before;
+
+    if (!baseline.empty()) {
+        before = read_json(baseline);
+    }
+
+    std::cout << std::left << std::setw(10) << "level" << std::right
+        << std::setw(12) << "status" << std::setw(8) << "pushes"
+        << std::setw(10) << "nodes" << std::setw(10) << "ms"
+        << std::setw(12) << "nodes/s" << std::setw(10) << "peak KiB"
+        << (before.empty() ? "" : "    pushes    nodes       ms") << '\n'
+        << std::fixed << std::setprecision(1);
+    bool regressed = false;
+    unsigned int solved = 0;
+    unsigned int solved_before = 0;
+    unsigned long nodes = 0;
+    double ms = 0;
+
+    for (const Run &now : runs) {
+        solved += now.status == "solved";
+        nodes += now.nodes;
+        ms += now.ms;
+        std::cout << std::left << std::setw(10) << now.level << std::right
+            << std::setw(12) << (now.optimal ? "optimal" : now.status)
+            << std::setw(8) << now.pushes << std::setw(10) << now.nodes
+            << std::setw(10) << now.ms
+            << std::setw(12) << std::setprecision(0) << now.nodes_per_s()
+            << std::setw(10) << now.peak_bytes / 1024.0
+            << std::setprecision(1);
+
+        for (const Run &then : before) {
+            if (then.level != now.level) {
+                continue;
+            }
+
+            solved_before += then.status == "solved";
+
+            // Nodes only change with the search itself, time also with the
+            // machine, so both get the threshold; a lost or longer solution
+            // always counts
+            const bool lost = then.status == "solved" &&
+                now.status != "solved";
+            const bool longer = then.status == "solved" && !lost &&
+                now.pushes > then.pushes;
+            const bool slower =
+                now.nodes > then.nodes * (1 + threshold / 100) ||
+                now.ms > then.ms * (1 + threshold / 100);
+            regressed = regressed || lost || longer || slower;
+            std::string flag;
+
+            if (lost) {
+                flag = "  LOST";
+            }
+            else if (longer) {
+                flag = "  LONGER";
+            }
+            else if (slower) {
+                flag = "  REGRESSION";
+            }
+
+            std::cout << std::setw(10) << std::showpos
+                << (int) now.pushes - (int) then.pushes << std::noshowpos
+                << std::setw(9) << percent(then.nodes, now.nodes)
+                << std::setw(9) << percent(then.ms, now.ms) << flag;
+        }
+
+        std::cout << '\n';
+    }
+
+    std::cout << "solved " << solved << " of " << runs.size();
+
+    if (!before.empty()) {
+        std::cout << " (baseline " << solved_before << ")";
+    }
+
+    std::cout << ", " << nodes << " nodes in " << std::setprecision(0) << ms
+        << " ms\n";
+
+    if (!csv.empty()) {
+        write_csv(csv, runs);
+    }
+
+    if (!json.empty()) {
+        write_json(json, runs);
+    }
+
+    return regressed ? 1 : 0;
+}
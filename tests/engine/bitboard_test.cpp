@@ -0,0 +1,106 @@
+#include <cstdlib>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/bitboard.hpp"
+
+// A random grid of the given size with a wall around it
+static Bitboard random_grid(unsigned int width, unsigned int height) {
+    Bitboard grid(width * height, width);
+    std::srand(width * height);
+
+    for (unsigned int y = 1; y < height - 1; y++) {
+        for (unsigned int x = 1; x < width - 1; x++) {
+            if (std::rand() % 3) {
+                grid.set(y * width + x);
+            }
+        }
+    }
+
+    return grid;
+}
+
+// The cells connected to a cell, found one cell at a time
+static Bitboard search(const Bitboard &grid, unsigned int width,
+                       unsigned int cells, unsigned int from) {
+    Bitboard reached(cells, width);
+    std::vector<unsigned int> stack = {from};
+    reached.set(from);
+
+    while (!stack.empty()) {
+        const unsigned int cell = stack.back();
+        stack.pop_back();
+
+        for (const unsigned int next :
+                {cell - 1, cell + 1, cell - width, cell + width}) {
+            if (grid.test(next) && !reached.test(next)) {
+                reached.set(next);
+                stack.push_back(next);
+            }
+        }
+    }
+
+    return reached;
+}
+
+TEST_SUITE("Test cases for Bitboard") {
+
+    TEST_CASE("should set, reset and subtract cells") {
+        Bitboard a(200, 20);
+        Bitboard b(200, 20);
+        a.set(21);
+        a.set(63);
+        a.set(64);
+        a.set(150);
+        CHECK(a.test(63));
+        CHECK(a.test(64));
+        CHECK(!a.test(65));
+        CHECK(a.first() == 21);
+        a.reset(21);
+        CHECK(!a.test(21));
+        CHECK(a.first() == 63);
+        b.set(63);
+        b.set(150);
+        a.subtract(b);
+        CHECK(!a.test(63));
+        CHECK(a.test(64));
+        CHECK(!a.test(150));
+        CHECK(a.first() == 64);
+    }
+
+    TEST_CASE("should flood only the connected cells") {
+        // Two rooms split by a wall at x = 4
+        Bitboard grid(8 * 5, 8);
+
+        for (unsigned int y = 1; y < 4; y++) {
+            for (unsigned int x = 1; x < 7; x++) {
+                if (x != 4) {
+                    grid.set(y * 8 + x);
+                }
+            }
+        }
+
+        const Bitboard left = grid.flood(9);
+        CHECK(left.first() == 9);
+        CHECK(left.test(27));
+        CHECK(!left.test(13));
+        CHECK(grid.flood(13).first() == 13);
+        grid.set(12);
+        CHECK(grid.flood(9).test(30));
+    }
+
+    TEST_CASE("should flood like a search on grids of any width") {
+        for (const unsigned int width : {7u, 20u, 63u, 64u, 65u, 130u}) {
+            const unsigned int height = 1 + 3000 / width;
+            const unsigned int cells = width * height;
+            const Bitboard grid = random_grid(width, height);
+
+            for (unsigned int from = 0; from < cells; from += 37) {
+                if (grid.test(from)) {
+                    CHECK(grid.flood(from) ==
+                          search(grid, width, cells, from));
+                }
+            }
+        }
+    }
+}
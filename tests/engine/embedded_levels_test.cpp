@@ -0,0 +1,41 @@
+#include <string_view>
+
+#include "doctest.h"
+#include "../../src/engine/embedded_levels.hpp"
+
+TEST_SUITE("Test cases for EmbeddedLevels") {
+
+    constexpr std::string_view playable[] = {
+        "#####",
+        "#+$ #",
+        "#####",
+    };
+    constexpr std::string_view no_player[] = {
+        "#####",
+        "# $.#",
+        "#####",
+    };
+    constexpr std::string_view two_players[] = {
+        "#####",
+        "#@$+#",
+        "#####",
+    };
+    constexpr std::string_view bad_symbol[] = {
+        "#####",
+        "#@$x#",
+        "#####",
+    };
+
+    TEST_CASE("should validate boards at compile time") {
+        static_assert(EmbeddedLevels::valid(playable));
+        static_assert(!EmbeddedLevels::valid(no_player));
+        static_assert(!EmbeddedLevels::valid(two_players));
+        static_assert(!EmbeddedLevels::valid(bad_symbol));
+        CHECK(EmbeddedLevels::valid(playable));
+    }
+
+    TEST_CASE("should embed no levels in the default build") {
+        CHECK(EmbeddedLevels::count == 0);
+        CHECK(EmbeddedLevels::levels().empty());
+    }
+}
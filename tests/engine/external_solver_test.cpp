@@ -0,0 +1,91 @@
+#include <cctype>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/external_solver.hpp"
+#include "../../src/engine/sokoban.hpp"
+
+TEST_SUITE("Test cases for ExternalSolver") {
+
+    const std::vector<std::string> level = {
+        "#######",
+        "#     #",
+        "# $$  #",
+        "#  @ .#",
+        "#   . #",
+        "#######",
+    };
+
+    TEST_CASE("should find an optimal solution while spilling every node") {
+        ExternalSolver solver(level);
+        ExternalSolver::Options options;
+        options.directory = ".";
+        options.memory_limit = 1;
+
+        auto result = solver.solve(options);
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.optimal);
+        CHECK(result.pushes == Solver(level).solve().pushes);
+
+        Sokoban soko({level});
+
+        for (const char c : result.solution) {
+            CHECK(soko.move((Sokoban::Direction) std::toupper(c)));
+        }
+        CHECK(soko.solved());
+    }
+
+    TEST_CASE("should report an unsolvable level") {
+        ExternalSolver solver({
+            "######",
+            "#@$ .#",
+            "#$  .#",
+            "######",
+        });
+        ExternalSolver::Options options;
+        options.directory = ".";
+
+        CHECK(solver.solve(options).status == Solver::UNSOLVABLE);
+    }
+
+    TEST_CASE("should stop on the node budget") {
+        ExternalSolver solver(level);
+        ExternalSolver::Options options;
+        options.directory = ".";
+        options.node_limit = 2;
+
+        auto result = solver.solve(options);
+        CHECK(result.status == Solver::BUDGET_EXHAUSTED);
+        CHECK(result.nodes == 2);
+    }
+
+    TEST_CASE("should give concurrent searches workspaces of their own") {
+        const std::filesystem::path directory = "external-workspaces";
+        std::filesystem::remove_all(directory);
+        std::vector<Solver::Result> results(4);
+        std::vector<std::thread> threads;
+
+        for (Solver::Result &result : results) {
+            threads.emplace_back([&] {
+                ExternalSolver::Options options;
+                options.directory = directory.string();
+                options.memory_limit = 1;
+                result = ExternalSolver(level).solve(options);
+            });
+        }
+
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        for (const Solver::Result &result : results) {
+            CHECK(result.status == Solver::SOLVED);
+            CHECK(result.pushes == results[0].pushes);
+        }
+
+        CHECK(std::filesystem::is_empty(directory));
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,62 @@
+#include <cctype>
+
+#include "doctest.h"
+#include "../../src/engine/hint.hpp"
+#include "../../src/engine/sokoban.hpp"
+
+TEST_SUITE("Test cases for Hint") {
+
+    const std::vector<std::string> level = {
+        "#######",
+        "#     #",
+        "# $$  #",
+        "#  @ .#",
+        "#   . #",
+        "#######",
+    };
+
+    /**
+     * Follow hints until the level is solved or they run out
+    */
+    unsigned int follow(Sokoban &soko, Hint &hint) {
+        unsigned int moves = 0;
+
+        for (char move = hint.next(soko.board()); move && moves < 100;
+             move = hint.next(soko.board())) {
+            CHECK(soko.move((Sokoban::Direction) std::toupper(move)));
+            moves++;
+        }
+
+        return moves;
+    }
+
+    TEST_CASE("should lead to a solution") {
+        Sokoban soko({level});
+        Hint hint(level);
+        follow(soko, hint);
+        CHECK(soko.solved());
+    }
+
+    TEST_CASE("should give no hint on a solved board") {
+        Hint hint({"#####", "#@* #", "#####"});
+        CHECK(hint.next({"#####", "#@* #", "#####"}) == 0);
+    }
+
+    TEST_CASE("should reconnect after the player strays from the line") {
+        Sokoban soko({level});
+        Hint hint(level);
+        CHECK(hint.next(soko.board()) != 0);
+        CHECK(soko.move(Sokoban::Direction::R));
+        CHECK(soko.move(Sokoban::Direction::U));
+        follow(soko, hint);
+        CHECK(soko.solved());
+    }
+
+    TEST_CASE("should give no hint in a deadlock") {
+        Sokoban soko({level});
+        Hint hint(level);
+        CHECK(soko.move(Sokoban::Direction::L));
+        CHECK(soko.move(Sokoban::Direction::U));
+        CHECK(hint.next(soko.board()) == 0);
+    }
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/level_pack.hpp"
+
+TEST_SUITE("Test cases for LevelPack") {
+
+    const std::vector<Level> levels = {
+        {{"#####", "#@$.#", "#####"}, "Someone", "First", "color purple"},
+        {{"  ####", "###+.#", "#  $*#", "#####"}, "", "Second", ""},
+    };
+
+    TEST_CASE("should round-trip boards and metadata") {
+        const LevelPack pack(LevelPack::encode(levels));
+        REQUIRE(pack.size() == 2);
+
+        for (unsigned int i = 0; i < pack.size(); i++) {
+            const Level level = pack.level(i);
+            CHECK(level.board == levels[i].board);
+            CHECK(level.author == levels[i].author);
+            CHECK(level.title == levels[i].title);
+            CHECK(level.comment == levels[i].comment);
+        }
+    }
+
+    TEST_CASE("should answer metadata from the index") {
+        const LevelPack pack(LevelPack::encode(levels));
+        CHECK(pack.rows(1) == 4);
+        CHECK(pack.columns(1) == 6);
+        CHECK(pack.boxes(0) == 1);
+        CHECK(pack.boxes(1) == 2);
+        CHECK(std::string(pack.title(1)) == "Second");
+        CHECK(std::string(pack.author(1)) == "");
+    }
+
+    TEST_CASE("should have no levels in an empty pack") {
+        const LevelPack pack;
+        CHECK(pack.size() == 0);
+        CHECK_THROWS_AS(pack.board(0), std::invalid_argument);
+    }
+
+    TEST_CASE("should reject cells it can't encode") {
+        const std::vector<Level> bad = {{{"#####", "#@x.#", "#####"}}};
+        CHECK_THROWS_AS(LevelPack::encode(bad), std::invalid_argument);
+    }
+
+    TEST_CASE("should reject data that isn't a sound pack") {
+        const std::string data = LevelPack::encode(levels);
+        CHECK_THROWS_AS(LevelPack{"SOKC"}, std::invalid_argument);
+        CHECK_THROWS_AS(LevelPack{data.substr(0, 40)},
+            std::invalid_argument);
+
+        std::string future = data;
+        future[4] = 2;
+        CHECK_THROWS_AS(LevelPack{future}, std::invalid_argument);
+    }
+
+    TEST_CASE("should fill in cells fetched after the index") {
+        const std::string data = LevelPack::encode(levels);
+
+        // Two levels of 3x5 and 4x6 cells follow a 16-byte header and two
+        // 24-byte index entries
+        const size_t first = 64;
+        const size_t second = first + (3 * 5 + 1) / 2;
+        const size_t strings = second + 4 * 6 / 2;
+        std::string blank = data;
+        std::fill(blank.begin() + first, blank.begin() + strings, '\0');
+        LevelPack pack(blank, false);
+        CHECK(std::string(pack.title(1)) == "Second");
+        CHECK_FALSE(pack.filled(1));
+        CHECK_THROWS_AS(pack.board(1), std::invalid_argument);
+
+        pack.fill(1, std::string_view(data).substr(second, strings - second));
+        CHECK(pack.filled(1));
+        CHECK_FALSE(pack.filled(0));
+        CHECK(pack.board(1) == levels[1].board);
+        CHECK_THROWS_AS(pack.fill(0, data.substr(first, 3)),
+            std::invalid_argument);
+        CHECK_THROWS_AS(pack.fill(2, ""), std::invalid_argument);
+    }
+}
@@ -0,0 +1,145 @@
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/level_parser.hpp"
+
+TEST_SUITE("Test cases for LevelParser") {
+
+    TEST_CASE("should read the board and metadata of an .xsb file") {
+        const Level level = LevelParser::parse(
+            "#####\n"
+            "#@$.#\n"
+            "#####\n"
+            "Author: Someone\n"
+            "Title: First #1\n"
+            "Comment:\n"
+            "color purple\n"
+            "two lines\n"
+            "Comment-End:\n"
+        );
+        const std::vector<std::string> board = {
+            "#####",
+            "#@$.#",
+            "#####",
+        };
+        CHECK(level.board == board);
+        CHECK(level.author == "Someone");
+        CHECK(level.title == "First #1");
+        CHECK(level.comment == "color purple\ntwo lines");
+    }
+
+    TEST_CASE("should skip leading text and strip carriage returns") {
+        const Level level = LevelParser::parse(
+            "; a collection header\r\n"
+            "\r\n"
+            "  ####\r\n"
+            "###@.#\r\n"
+            "#  $ #\r\n"
+            "######\r\n"
+            "title:  Spaced  \r\n"
+        );
+        const std::vector<std::string> board = {
+            "  ####",
+            "###@.#",
+            "#  $ #",
+            "######",
+        };
+        CHECK(level.board == board);
+        CHECK(level.title == "Spaced");
+        CHECK(level.author == "");
+    }
+
+    TEST_CASE("should end the board at the first line that isn't part of it") {
+        const Level level = LevelParser::parse(
+            "#####\n#@$.#\n#####\n\n#####\n"
+        );
+        CHECK(level.board.size() == 3);
+    }
+
+    TEST_CASE("should keep a one-line comment and ignore unknown keys") {
+        const Level level = LevelParser::parse(
+            "#####\n#@$.#\n#####\nComment: short\nDate: today\n"
+        );
+        CHECK(level.comment == "short");
+    }
+
+    TEST_CASE("should return an empty board for text without a level") {
+        CHECK(LevelParser::parse("").board.empty());
+        CHECK(LevelParser::parse("Title: nothing\n").board.empty());
+    }
+
+    TEST_CASE("should read level numbers from file names") {
+        CHECK(LevelParser::number("src/engine/levels/gri07.xsb") == 7);
+        CHECK(LevelParser::number("gri100.xsb") == 100);
+        CHECK_THROWS_AS(LevelParser::number("gri.xsb"),
+            std::invalid_argument);
+        CHECK_THROWS_AS(LevelParser::number("gri07.txt"),
+            std::invalid_argument);
+    }
+
+    const std::string collection =
+        "Title: A collection\n"
+        "Author: Collector\n"
+        "\n"
+        "#####\n"
+        "#@$.#\n"
+        "#####\n"
+        "Title: One\n"
+        "\n"
+        "######\n"
+        "#@$ .#\n"
+        "######\n"
+        "Title: Two\n"
+        "Author: Guest\n"
+        "Comment:\n"
+        "####\n"
+        "Comment-End:\n"
+        "#######\n"
+        "#@$  .#\n"
+        "#######\n";
+
+    TEST_CASE("should split a collection on level boundaries") {
+        std::string_view header;
+        const std::vector<std::string_view> levels =
+            LevelParser::split(collection, header);
+        REQUIRE(levels.size() == 3);
+        CHECK(header == "Title: A collection\nAuthor: Collector\n\n");
+        CHECK(levels[0].substr(0, 6) == "#####\n");
+        CHECK(levels[2] == "#######\n#@$  .#\n#######\n");
+    }
+
+    TEST_CASE("should parse a collection in order with its metadata") {
+        for (unsigned int threads : {1u, 4u}) {
+            const std::vector<Level> levels =
+                LevelParser::parse_collection(collection, threads);
+            REQUIRE(levels.size() == 3);
+            CHECK(levels[0].title == "One");
+            CHECK(levels[0].author == "Collector");
+            CHECK(levels[1].title == "Two");
+            CHECK(levels[1].author == "Guest");
+            CHECK(levels[1].comment == "####");
+            CHECK(levels[2].board[1] == "#@$  .#");
+            CHECK(levels[2].title == "");
+        }
+    }
+
+    TEST_CASE("should parse many levels the same on any number of threads") {
+        std::string text;
+
+        for (unsigned int i = 0; i < 1000; i++) {
+            text += "#####\n#@$.#\n#####\nTitle: " + std::to_string(i) +
+                "\n\n";
+        }
+
+        const std::vector<Level> levels =
+            LevelParser::parse_collection(text, 8);
+        REQUIRE(levels.size() == 1000);
+
+        for (unsigned int i = 0; i < levels.size(); i++) {
+            CHECK(levels[i].title == std::to_string(i));
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/level_store.hpp"
+#include "../../src/engine/sokoban.hpp"
+
+TEST_SUITE("Test cases for LevelStore") {
+
+    const std::vector<Level> levels = {
+        {{"#####", "#@$.#", "#####"}, "Someone", "First", ""},
+        {{"######", "#@$ .#", "######"}, "", "Second", ""},
+    };
+
+    TEST_CASE("should decode each level once and share it") {
+        const LevelStore store(LevelPack(LevelPack::encode(levels)));
+        REQUIRE(store.size() == 2);
+        const LevelStore::Board first = store.board(1);
+        CHECK(*first == levels[1].board);
+        CHECK(store.board(1) == first);
+        CHECK(std::string(store.title(0)) == "First");
+        CHECK(std::string(store.author(0)) == "Someone");
+    }
+
+    TEST_CASE("should add decoded levels after the pack") {
+        LevelStore store(LevelPack(LevelPack::encode(levels)));
+        store.add({{"####", "#@.#", "#$ #", "####"}, "Me", "Extra", ""});
+        REQUIRE(store.size() == 3);
+        CHECK(store.board(2)->at(2) == "#$ #");
+        CHECK(std::string(store.title(2)) == "Extra");
+        CHECK_THROWS_AS(store.board(3), std::invalid_argument);
+        CHECK(std::string(store.title(3)) == "");
+        CHECK(std::string(store.author(3)) == "");
+    }
+
+    TEST_CASE("should keep added titles valid as more levels are added") {
+        LevelStore store(LevelPack(LevelPack::encode(levels)));
+        store.add({{"####", "#@.#", "#$ #", "####"}, "Me", "Extra", ""});
+        const char *title = store.title(2);
+        const char *author = store.author(2);
+
+        for (unsigned int i = 0; i < 1000; i++) {
+            store.add({{"####", "#@.#", "#$ #", "####"}, "", "More", ""});
+        }
+
+        CHECK(title == store.title(2));
+        CHECK(author == store.author(2));
+        CHECK(std::string(title) == "Extra");
+    }
+
+    TEST_CASE("should let engines share a store without sharing boards") {
+        const auto store = std::make_shared<const LevelStore>(
+            LevelPack(LevelPack::encode(levels))
+        );
+        Sokoban first(store);
+        Sokoban second(store);
+        CHECK(first.move(Sokoban::R));
+        CHECK(first.solved());
+        CHECK(!second.solved());
+        second.change_level(1);
+        CHECK(second.board() == levels[1].board);
+        first.reset();
+        CHECK(first.board() == levels[0].board);
+    }
+
+    TEST_CASE("should refuse a level until its cells are filled in") {
+        const std::string data = LevelPack::encode(levels);
+
+        // The second level's 3x6 cells sit between the first level's 3x5
+        // and the strings
+        const size_t second = 64 + (3 * 5 + 1) / 2;
+        const size_t strings = second + 3 * 6 / 2;
+        std::string blank = data;
+        std::fill(blank.begin() + second, blank.begin() + strings, '\0');
+        const auto store = std::make_shared<LevelStore>(
+            LevelPack(blank, false)
+        );
+        store->fill(0, std::string_view(data).substr(64, second - 64));
+        Sokoban soko(store);
+        CHECK(soko.move(Sokoban::R));
+
+        CHECK_THROWS_AS(store->board(1), std::invalid_argument);
+        CHECK_THROWS_AS(soko.change_level(1), std::invalid_argument);
+        CHECK(soko.level() == 0);
+        CHECK(soko.solved());
+
+        store->fill(1, std::string_view(data).substr(second, strings - second));
+        CHECK(*store->board(1) == levels[1].board);
+        soko.change_level(1);
+        CHECK(soko.board() == levels[1].board);
+    }
+
+    TEST_CASE("should leave the game alone for a board without a player") {
+        const auto store = std::make_shared<LevelStore>(
+            std::vector<std::vector<std::string>>{levels[0].board}
+        );
+        store->add({{"####", "# .#", "#$ #", "####"}, "", "", ""});
+        Sokoban soko(store);
+        CHECK(soko.move(Sokoban::R));
+
+        CHECK_THROWS_AS(soko.change_level(1), std::invalid_argument);
+        CHECK(soko.level() == 0);
+        CHECK(soko.solved());
+        CHECK(soko.undo());
+        CHECK(soko.board() == levels[0].board);
+    }
+}
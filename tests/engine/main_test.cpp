@@ -0,0 +1,87 @@
+#include <string>
+
+#include "doctest.h"
+
+extern "C" {
+int sokoban_create();
+void sokoban_destroy(int session);
+const char *sokoban_board_to_string(int session);
+bool sokoban_move(int session, char *s);
+int sokoban_move_batch(int session, const char *directions);
+const int *sokoban_changes(int session);
+bool sokoban_undo(int session);
+int sokoban_node(int session);
+int sokoban_level(int session);
+void sokoban_reset(int session);
+const char *sokoban_sequence(int session);
+int sokoban_moves(int session);
+const char *sokoban_hint(int session);
+const char *sokoban_serialize(int session);
+int sokoban_serialized_size(int session);
+bool sokoban_deserialize(int session, const char *blob, int size);
+const char *sokoban_level_title(int level);
+const char *sokoban_level_author(int level);
+}
+
+TEST_SUITE("Test cases for the C API") {
+
+    TEST_CASE("should play a game through its handle") {
+        const int session = sokoban_create();
+        char right[] = "R";
+        CHECK(session > 0);
+        CHECK(sokoban_move(session, right));
+        CHECK(sokoban_moves(session) == 1);
+        CHECK(std::string(sokoban_sequence(session)).size() == 1);
+        CHECK(sokoban_undo(session));
+        CHECK(sokoban_move_batch(session, "R") == 2);
+        CHECK(sokoban_changes(session) != nullptr);
+        sokoban_destroy(session);
+    }
+
+    TEST_CASE("should refuse a direction it doesn't know without throwing") {
+        const int session = sokoban_create();
+        char unknown[] = "x";
+        char none[] = "";
+        CHECK_FALSE(sokoban_move(session, unknown));
+        CHECK_FALSE(sokoban_move(session, none));
+        CHECK(sokoban_moves(session) == 0);
+        sokoban_destroy(session);
+    }
+
+    TEST_CASE("should reject a destroyed handle without throwing") {
+        const int session = sokoban_create();
+        char right[] = "R";
+        CHECK(sokoban_move(session, right));
+        const std::string saved(
+            sokoban_serialize(session), sokoban_serialized_size(session)
+        );
+        sokoban_destroy(session);
+
+        CHECK(std::string(sokoban_board_to_string(session)).empty());
+        CHECK(!sokoban_move(session, right));
+        CHECK(sokoban_move_batch(session, "R") == 0);
+        CHECK(sokoban_changes(session) == nullptr);
+        CHECK(!sokoban_undo(session));
+        CHECK(sokoban_node(session) == -1);
+        CHECK(sokoban_level(session) == -1);
+        CHECK(sokoban_moves(session) == -1);
+        CHECK(std::string(sokoban_sequence(session)).empty());
+        CHECK(std::string(sokoban_hint(session)).empty());
+        CHECK(sokoban_serialized_size(session) == -1);
+        CHECK(!sokoban_deserialize(session, saved.data(), saved.size()));
+        sokoban_reset(session);
+        sokoban_destroy(session);
+        CHECK(sokoban_moves(0) == -1);
+
+        const int reused = sokoban_create();
+        CHECK(reused != session);
+        CHECK(sokoban_moves(reused) == 0);
+        sokoban_destroy(reused);
+    }
+
+    TEST_CASE("should return no title or author for a missing level") {
+        REQUIRE(sokoban_level_title(1 << 20) != nullptr);
+        CHECK(std::string(sokoban_level_title(1 << 20)).empty());
+        CHECK(std::string(sokoban_level_author(-1)).empty());
+    }
+}
@@ -0,0 +1,81 @@
+#include <stdexcept>
+
+#include "doctest.h"
+#include "../../src/engine/maze.hpp"
+
+TEST_SUITE("Test cases for Maze") {
+
+    TEST_CASE("should normalize the player to the top-left reachable cell") {
+        Maze maze({
+            "######",
+            "#    #",
+            "# $ @#",
+            "#.   #",
+            "######",
+        });
+        CHECK(maze.initial().player == maze.cell(1, 1));
+        CHECK(maze.initial().boxes.size() == 1);
+    }
+
+    TEST_CASE("should treat equivalent player positions as the same state") {
+        Maze maze({
+            "######",
+            "#@   #",
+            "# $  #",
+            "#.   #",
+            "######",
+        });
+        std::vector<std::string> moved = {
+            "######",
+            "#    #",
+            "# $ @#",
+            "#.   #",
+            "######",
+        };
+        CHECK(maze.state(moved) == maze.initial());
+    }
+
+    TEST_CASE("should not generate pushes onto dead squares") {
+        Maze maze({
+            "#####",
+            "#   #",
+            "#@$.#",
+            "#   #",
+            "#####",
+        });
+        auto successors = maze.successors(maze.initial());
+
+        // Any push but right leaves the box on a wall with no goal
+        CHECK(successors.size() == 1);
+        CHECK(successors.at(0).push.direction == 3);
+    }
+
+    TEST_CASE("should estimate the pushes left to reach a goal") {
+        Maze maze({
+            "#######",
+            "#@$  .#",
+            "#######",
+        });
+        CHECK(maze.heuristic(maze.initial()) == 3);
+    }
+
+    TEST_CASE("should expand a line of pushes into LURD moves") {
+        Maze maze({
+            "######",
+            "#@   #",
+            "# $ .#",
+            "#    #",
+            "######",
+        });
+        std::vector<Maze::Push> line = {
+            {(unsigned short) maze.cell(2, 2), 3},
+            {(unsigned short) maze.cell(2, 3), 3},
+        };
+        CHECK(maze.moves(maze.start(), maze.initial().boxes, line) == "dRR");
+    }
+
+    TEST_CASE("should reject a board without a player") {
+        const std::vector<std::string> board = {"####", "#$.#", "####"};
+        CHECK_THROWS_AS(Maze{board}, std::invalid_argument);
+    }
+}
@@ -0,0 +1,50 @@
+#include <string>
+
+#include "doctest.h"
+#include "../../src/engine/move_sequence.hpp"
+
+TEST_SUITE("Test cases for MoveSequence") {
+
+    TEST_CASE("should count moves and pushes as they are made and undone") {
+        MoveSequence sequence;
+        CHECK(sequence.empty());
+        sequence.push_back({'U', false, true});
+        sequence.push_back({'R', true, true});
+        sequence.push_back({'R', true, false});
+        CHECK(sequence.size() == 3);
+        CHECK(sequence.pushes() == 2);
+        sequence.pop_back();
+        CHECK(sequence.size() == 2);
+        CHECK(sequence.pushes() == 1);
+        sequence.clear();
+        CHECK(sequence.empty());
+        CHECK(sequence.pushes() == 0);
+        sequence.pop_back();
+        CHECK(sequence.empty());
+    }
+
+    TEST_CASE("should pack directions across bytes") {
+        const std::string moves = "UDLRRLDUU";
+        MoveSequence sequence;
+
+        for (const char move : moves) {
+            sequence.push_back({move, move == 'L', move == 'D'});
+        }
+
+        CHECK(sequence.str() == moves);
+        CHECK(sequence[6].direction == 'D');
+        CHECK(sequence[6].fast_forward);
+        CHECK(sequence[5].push);
+        CHECK_FALSE(sequence[4].push);
+
+        // Popping clears a code so a different direction can replace it
+        sequence.pop_back();
+        sequence.pop_back();
+        sequence.push_back({'R', true, false});
+        CHECK(sequence.str() == "UDLRRLDR");
+        CHECK(sequence.back().direction == 'R');
+        CHECK(sequence.back().push);
+        sequence.mark_back(true);
+        CHECK(sequence.back().fast_forward);
+    }
+}
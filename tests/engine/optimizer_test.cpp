@@ -0,0 +1,63 @@
+#include <cctype>
+
+#include "doctest.h"
+#include "../../src/engine/optimizer.hpp"
+#include "../../src/engine/sokoban.hpp"
+
+TEST_SUITE("Test cases for Optimizer") {
+
+    const std::vector<std::string> level = {
+        "#######",
+        "#     #",
+        "# $$  #",
+        "#  @ .#",
+        "#   . #",
+        "#######",
+    };
+
+    TEST_CASE("should remove detours between pushes") {
+        Optimizer optimizer(level);
+        CHECK(optimizer.optimize("rrlllrl", {}) == "");
+        CHECK(optimizer.optimize("rllrlluurDurDlDRlldRurRlldR", {}) ==
+            "ruulDulDDRRllldRR");
+    }
+
+    TEST_CASE("should accept a solution in the engine's uppercase moves") {
+        Optimizer optimizer(level);
+        const std::string result =
+            optimizer.optimize("LLUURDURDLDRLLDRURRLLDR", {});
+        CHECK(result == "ruulDulDDRRllldRR");
+    }
+
+    TEST_CASE("should find shortcuts that reorder pushes") {
+        Optimizer optimizer(level);
+        const std::string result =
+            optimizer.optimize("lluurDurDlDRlldRurRlldR", {});
+        Sokoban soko({level});
+
+        for (const char c : result) {
+            CHECK(soko.move((Sokoban::Direction) std::toupper(c)));
+        }
+        CHECK(soko.solved());
+        CHECK(result.size() < 23);
+    }
+
+    TEST_CASE("should reject a solution that doesn't solve the level") {
+        Optimizer optimizer(level);
+        CHECK(optimizer.optimize("lluurD", {}) == "");
+        CHECK(optimizer.optimize("xyz", {}) == "");
+    }
+
+    TEST_CASE("should optimize a batch across threads in job order") {
+        std::vector<Optimizer::Job> jobs = {
+            {level, "rllrlluurDurDlDRlldRurRlldR"},
+            {level, "bad"},
+            {{"#####", "#@$.#", "#####"}, "rlR"},
+        };
+        auto results = Optimizer::optimize(jobs, {}, 3);
+        CHECK(results.size() == 3);
+        CHECK(results[0] == "ruulDulDDRRllldRR");
+        CHECK(results[1] == "");
+        CHECK(results[2] == "R");
+    }
+}
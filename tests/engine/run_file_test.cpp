@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/run_file.hpp"
+
+TEST_SUITE("Test cases for RunFile") {
+
+    TEST_CASE("should read back sorted records with shared prefixes") {
+        const std::string path = "run_file_test.run";
+        const std::vector<std::vector<unsigned char>> records = {
+            {0, 0, 0, 0},
+            {0, 0, 0, 7},
+            {0, 3, 1, 2},
+            {0, 3, 1, 9},
+            {5, 0, 0, 0},
+        };
+
+        RunFile::Writer writer(path, 4);
+
+        for (const auto &record : records) {
+            writer.write(record.data());
+        }
+
+        writer.close();
+        CHECK(writer.count() == records.size());
+
+        RunFile::Reader reader(path, 4);
+        std::vector<std::vector<unsigned char>> read;
+
+        while (reader.next()) {
+            read.push_back(reader.record());
+        }
+
+        CHECK(read == records);
+        reader.close();
+        CHECK(!reader.next());
+        CHECK(std::remove(path.c_str()) == 0);
+    }
+}
@@ -0,0 +1,65 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/session_pool.hpp"
+
+TEST_SUITE("Test cases for SessionPool") {
+
+    const std::vector<std::vector<std::string>> boards = {
+        {"#####", "#@$.#", "#####"},
+        {"######", "#@$ .#", "######"},
+    };
+
+    TEST_CASE("should keep sessions independent on shared levels") {
+        const auto levels = std::make_shared<const LevelStore>(boards);
+        SessionPool pool;
+        const unsigned int first = pool.create(levels);
+        const unsigned int second = pool.create(levels);
+        CHECK(first != 0);
+        CHECK(first != second);
+        CHECK(pool.size() == 2);
+
+        CHECK(pool.at(first).soko.move(Sokoban::R));
+        CHECK(pool.at(first).soko.solved());
+        CHECK(!pool.at(second).soko.solved());
+        pool.at(second).soko.change_level(1);
+        CHECK(pool.at(first).soko.level() == 0);
+        CHECK(pool.at(second).levels == levels);
+    }
+
+    TEST_CASE("should reject destroyed handles even after reuse") {
+        const auto levels = std::make_shared<const LevelStore>(boards);
+        SessionPool pool;
+        const unsigned int first = pool.create(levels);
+        pool.destroy(first);
+        CHECK(pool.size() == 0);
+        CHECK_THROWS_AS(pool.at(first), std::invalid_argument);
+        CHECK_THROWS_AS(pool.destroy(first), std::invalid_argument);
+
+        const unsigned int reused = pool.create(levels);
+        CHECK(reused != first);
+        CHECK(pool.at(reused).soko.board() == boards[0]);
+        CHECK_THROWS_AS(pool.at(first), std::invalid_argument);
+        CHECK_THROWS_AS(pool.at(0), std::invalid_argument);
+        CHECK(pool.find(first) == nullptr);
+        CHECK(pool.find(0) == nullptr);
+        CHECK(pool.find(reused) == &pool.at(reused));
+    }
+
+    TEST_CASE("should keep sessions at their addresses as the pool grows") {
+        const auto levels = std::make_shared<const LevelStore>(boards);
+        SessionPool pool;
+        const unsigned int first = pool.create(levels);
+        const Session *session = &pool.at(first);
+
+        for (unsigned int i = 0; i < 1000; i++) {
+            pool.create(levels);
+        }
+
+        CHECK(&pool.at(first) == session);
+        CHECK(pool.size() == 1001);
+    }
+}
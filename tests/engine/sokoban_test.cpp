@@ -1286,3 +1286,335 @@ TEST_SUITE("Test cases for sequence()") {
         CHECK(soko.board() == expected);
     }
 }
+
+TEST_SUITE("Test cases for serialize() and deserialize()") {
+
+    TEST_CASE("should restore the board, position and history") {
+        std::vector<std::vector<std::string>> levels = {{
+            "######",
+            "#    #",
+            "#@$ .#",
+            "######",
+        }, {
+            "#####",
+            "#@$.#",
+            "#####",
+        }};
+        Sokoban soko(levels);
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::U));
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::D));
+        Sokoban restored(levels);
+        restored.change_level(1);
+        restored.deserialize(soko.serialize());
+        CHECK(restored.level() == 0);
+        CHECK(restored.board() == soko.board());
+        CHECK(restored.sequence() == "RURRD");
+
+        std::vector<std::string> expected = {
+            "######",
+            "#    #",
+            "#@$ .#",
+            "######",
+        };
+        for (int i = 0; i < 5; i++) {
+            CHECK(restored.undo());
+        }
+
+        CHECK_FALSE(restored.undo());
+        CHECK(restored.board() == expected);
+        CHECK(restored.move(Direction::R));
+        CHECK(restored.move(Direction::R));
+        CHECK(restored.solved());
+    }
+
+    TEST_CASE("should restore a box and player on goals") {
+        std::vector<std::vector<std::string>> levels = {{
+            "######",
+            "#@$..#",
+            "######",
+        }};
+        Sokoban soko(levels);
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::R));
+        CHECK_FALSE(soko.move(Direction::R));
+        Sokoban restored(levels);
+        restored.deserialize(soko.serialize());
+
+        std::vector<std::string> expected = {
+            "######",
+            "#  +*#",
+            "######",
+        };
+        CHECK(restored.board() == expected);
+        CHECK(restored.undo());
+        expected = {
+            "######",
+            "# @*.#",
+            "######",
+        };
+        CHECK(restored.board() == expected);
+    }
+
+    TEST_CASE("should reject blobs that don't fit") {
+        std::vector<std::vector<std::string>> levels = {{
+            "#####",
+            "#@$.#",
+            "#####",
+        }, {
+            "######",
+            "#@$ .#",
+            "######",
+        }};
+        Sokoban soko(levels);
+        const std::string blob = soko.serialize();
+        soko.change_level(1);
+        const std::vector<std::string> board = soko.board();
+
+        std::string other_version = blob;
+        other_version[4]++;
+        std::string missing_level = blob;
+        missing_level[5] = 9;
+        std::string box_in_wall = blob;
+        box_in_wall[17] = 1;
+        std::string player_in_wall = blob;
+        player_in_wall[9] = 0;
+
+        CHECK_THROWS_AS(soko.deserialize(""), std::invalid_argument);
+        CHECK_THROWS_AS(soko.deserialize(other_version),
+            std::invalid_argument);
+        CHECK_THROWS_AS(soko.deserialize(missing_level),
+            std::invalid_argument);
+        CHECK_THROWS_AS(soko.deserialize(box_in_wall), std::invalid_argument);
+        CHECK_THROWS_AS(soko.deserialize(player_in_wall),
+            std::invalid_argument);
+        CHECK_THROWS_AS(soko.deserialize(blob.substr(0, blob.size() - 1)),
+            std::invalid_argument);
+        CHECK(soko.level() == 1);
+        CHECK(soko.board() == board);
+    }
+
+    TEST_CASE("should reject a history the board can't have come from") {
+        std::vector<std::vector<std::string>> levels = {{
+            "#######",
+            "#  @  #",
+            "#######",
+        }};
+        Sokoban soko(levels);
+
+        for (int i = 0; i < 4; i++) {
+            CHECK(soko.move(Direction::R));
+            CHECK(soko.move(Direction::L));
+        }
+
+        // Eight moves take two bytes of directions, then a byte each of
+        // push and fast-forward bits; "U" is code 0
+        std::string pushes_up = soko.serialize();
+        const size_t moves = pushes_up.size() - 4;
+        pushes_up[moves] = 0;
+        pushes_up[moves + 1] = 0;
+        pushes_up[moves + 2] = (char) 0xff;
+
+        // Two steps right, which would leave the player two cells left of
+        // the level's start
+        soko.reset();
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::L));
+        std::string wrong_start = soko.serialize();
+        wrong_start[wrong_start.size() - 3] = 0x0f;
+
+        Sokoban restored(levels);
+        CHECK_THROWS_AS(restored.deserialize(pushes_up),
+            std::invalid_argument);
+        CHECK_THROWS_AS(restored.deserialize(wrong_start),
+            std::invalid_argument);
+        CHECK(restored.moves() == 0);
+        CHECK_FALSE(restored.undo());
+        CHECK(restored.board() == levels[0]);
+    }
+}
+
+TEST_SUITE("Test cases for moves() and pushes()") {
+
+    TEST_CASE("should count moves and pushes through undo and reset") {
+        Sokoban soko({{
+            "######",
+            "#    #",
+            "#@$ .#",
+            "######",
+        }});
+        CHECK(soko.moves() == 0);
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::U));
+        CHECK_FALSE(soko.move(Direction::U));
+        CHECK(soko.moves() == 2);
+        CHECK(soko.pushes() == 1);
+        CHECK(soko.undo());
+        CHECK(soko.undo());
+        CHECK(soko.moves() == 0);
+        CHECK(soko.pushes() == 0);
+        CHECK(soko.redo());
+        CHECK(soko.pushes() == 1);
+        soko.reset();
+        CHECK(soko.moves() == 0);
+        CHECK(soko.pushes() == 0);
+    }
+}
+
+TEST_SUITE("Test cases for variations and jump()") {
+
+    TEST_CASE("should keep an undone line as a variation") {
+        Sokoban soko({{
+            "######",
+            "#    #",
+            "#@$ .#",
+            "######",
+        }});
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::R));
+        const unsigned int solved = soko.node();
+        CHECK(soko.solved());
+        CHECK(soko.undo());
+        const unsigned int branch = soko.node();
+        CHECK(soko.move(Direction::U));
+        CHECK(soko.move(Direction::R));
+        const unsigned int other = soko.node();
+        CHECK(soko.variations(branch).size() == 2);
+        CHECK(soko.parent(solved) == branch);
+
+        CHECK(soko.jump(solved));
+        CHECK(soko.solved());
+        CHECK(soko.sequence() == "RR");
+        CHECK(soko.pushes() == 2);
+        CHECK(soko.jump(other));
+        CHECK(soko.sequence() == "RUR");
+        CHECK(soko.pushes() == 1);
+        CHECK(soko.jump(0));
+        CHECK(soko.moves() == 0);
+        CHECK_FALSE(soko.jump(99));
+        CHECK(soko.redo());
+        CHECK(soko.sequence() == "R");
+    }
+
+    TEST_CASE("should forget the variations on a new level") {
+        Sokoban soko({{
+            "#####",
+            "#@$.#",
+            "#####",
+        }});
+        CHECK(soko.move(Direction::R));
+        soko.reset();
+        CHECK(soko.node() == 0);
+        CHECK(soko.variations(0).empty());
+        CHECK_FALSE(soko.jump(1));
+    }
+}
+
+TEST_SUITE("Test cases for move_batch()") {
+
+    TEST_CASE("should report each changed cell once") {
+        Sokoban soko({{
+            "#######",
+            "#@ $ .#",
+            "#     #",
+            "#######",
+        }});
+        const std::vector<Sokoban::Change> changes = soko.move_batch("RRD");
+        std::vector<std::string> expected = {
+            "#######",
+            "#   $.#",
+            "#  @  #",
+            "#######",
+        };
+        CHECK(soko.board() == expected);
+        CHECK(soko.moves() == 3);
+        CHECK(soko.pushes() == 1);
+
+        // The cell the player passed through is left out
+        REQUIRE(changes.size() == 4);
+        CHECK(changes[0].y == 1);
+        CHECK(changes[0].x == 1);
+        CHECK(changes[0].cell == ' ');
+        CHECK(changes[1].x == 3);
+        CHECK(changes[1].cell == ' ');
+        CHECK(changes[2].x == 4);
+        CHECK(changes[2].cell == '$');
+        CHECK(changes[3].y == 2);
+        CHECK(changes[3].x == 3);
+        CHECK(changes[3].cell == '@');
+    }
+
+    TEST_CASE("should skip blocked moves and leave out unchanged cells") {
+        Sokoban soko({{
+            "######",
+            "#@ $.#",
+            "######",
+        }});
+        CHECK(soko.move_batch("URL").empty());
+        CHECK(soko.moves() == 2);
+        CHECK(soko.sequence() == "RL");
+        CHECK(soko.undo());
+        CHECK(soko.moves() == 1);
+    }
+
+    TEST_CASE("should push boxes and stop once solved") {
+        Sokoban soko({{
+            "######",
+            "#@$ .#",
+            "######",
+        }});
+        const std::vector<Sokoban::Change> changes = soko.move_batch("RRLL");
+        CHECK(soko.solved());
+        CHECK(soko.sequence() == "RR");
+        CHECK(soko.pushes() == 2);
+        CHECK(changes.size() == 4);
+        CHECK(changes[3].cell == '*');
+        CHECK(soko.move_batch("L").empty());
+        CHECK(soko.moves() == 2);
+    }
+
+    TEST_CASE("should reject an invalid direction without moving") {
+        Sokoban soko({{
+            "#####",
+            "#@  #",
+            "#####",
+        }});
+        CHECK_THROWS_AS(soko.move_batch("RX"), std::invalid_argument);
+        CHECK(soko.moves() == 0);
+    }
+}
+
+TEST_SUITE("Test cases for stats()") {
+
+    TEST_CASE("should count work only in instrumented builds") {
+        Sokoban soko({{
+            "#######",
+            "#@ $ .#",
+            "#     #",
+            "#######",
+        }});
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.move(Direction::R));
+        CHECK(soko.undo());
+        CHECK(soko.redo());
+        CHECK(soko.move(2, 1));
+        const Sokoban::Stats stats = soko.stats();
+
+        if constexpr (instrumented) {
+            // The walk from (1, 3) is three steps: down, left, left
+            CHECK(stats.moves == 6);
+            CHECK(stats.pushes == 2);
+            CHECK(stats.undos == 1);
+            CHECK(stats.redos == 1);
+            CHECK(stats.walk_nodes > 0);
+            CHECK(stats.history_bytes > 0);
+        }
+        else {
+            CHECK(stats.moves == 0);
+            CHECK(stats.walk_nodes == 0);
+            CHECK(stats.history_bytes == 0);
+        }
+    }
+}
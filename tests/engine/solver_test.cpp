@@ -0,0 +1,274 @@
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "doctest.h"
+#include "../../src/engine/sokoban.hpp"
+#include "../../src/engine/solver.hpp"
+
+namespace {
+
+const std::vector<std::string> two_boxes = {
+    "#######",
+    "#     #",
+    "# $$  #",
+    "#  @ .#",
+    "#   . #",
+    "#######",
+};
+
+/**
+ * Replay a LURD line on a fresh game of the level
+*/
+bool replays(const std::vector<std::string> &level, const std::string &line) {
+    Sokoban soko({level});
+
+    for (const char c : line) {
+        if (!soko.move((Sokoban::Direction) std::toupper(c))) {
+            return false;
+        }
+    }
+
+    return soko.solved();
+}
+
+}
+
+TEST_SUITE("Test cases for Solver") {
+
+    TEST_CASE("should find an optimal solution that replays") {
+        Solver solver(two_boxes);
+        auto result = solver.solve();
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.optimal);
+        CHECK(result.pushes == 7);
+        CHECK(result.bound == 7);
+        CHECK(replays(two_boxes, result.solution));
+    }
+
+    TEST_CASE("should return an empty solution for a solved level") {
+        Solver solver({
+            "#####",
+            "#@* #",
+            "#####",
+        });
+        auto result = solver.solve();
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.solution == "");
+    }
+
+    TEST_CASE("should report an unsolvable level") {
+        Solver solver({
+            "######",
+            "#@$ .#",
+            "#$  .#",
+            "######",
+        });
+        auto result = solver.solve();
+        CHECK(result.status == Solver::UNSOLVABLE);
+        CHECK(result.solution == "");
+    }
+
+    TEST_CASE("should stop on the node budget and continue on the next call") {
+        Solver solver(two_boxes);
+        Solver::Options options;
+        options.node_limit = 2;
+
+        auto partial = solver.solve(options);
+        CHECK(partial.status == Solver::BUDGET_EXHAUSTED);
+        CHECK(partial.nodes == 2);
+        CHECK_FALSE(partial.optimal);
+        CHECK(partial.bound <= 7);
+
+        auto result = solver.solve();
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.pushes == 7);
+    }
+
+    TEST_CASE("should stop when cancelled") {
+        Solver solver(two_boxes);
+        std::atomic<bool> cancelled(true);
+        Solver::Options options;
+        options.cancelled = &cancelled;
+
+        auto result = solver.solve(options);
+        CHECK(result.status == Solver::CANCELLED);
+        CHECK(result.nodes == 0);
+    }
+
+    TEST_CASE("should report progress") {
+        Solver solver(two_boxes);
+        std::vector<Solver::Progress> reports;
+        Solver::Options options;
+        options.progress_interval = 1;
+        options.progress = [&](const Solver::Progress &progress) {
+            reports.push_back(progress);
+        };
+
+        auto result = solver.solve(options);
+        CHECK(reports.size() == result.nodes + 1);
+        CHECK(reports.back().nodes == result.nodes);
+        CHECK(reports.back().bound == 7);
+    }
+
+    TEST_CASE("should improve a weighted solution until it is optimal") {
+        Solver solver(two_boxes);
+        Solver::Options options;
+        options.weight = 5;
+
+        auto result = solver.solve(options);
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.optimal);
+        CHECK(result.pushes == 7);
+        CHECK(replays(two_boxes, result.solution));
+    }
+}
+
+TEST_SUITE("Test cases for Solver checkpoints") {
+
+    TEST_CASE("should solve optimally with several threads") {
+        Solver solver(two_boxes);
+        Solver::Options options;
+        options.threads = 4;
+
+        auto result = solver.solve(options);
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.pushes == 7);
+        CHECK(replays(two_boxes, result.solution));
+    }
+
+    TEST_CASE("should resume a search from a checkpoint") {
+        const std::string path = "solver_test.checkpoint";
+        Solver::Options options;
+        options.node_limit = 3;
+        options.checkpoint = path;
+
+        Solver first(two_boxes);
+        auto partial = first.solve(options);
+        CHECK(partial.status == Solver::BUDGET_EXHAUSTED);
+
+        Solver second(two_boxes);
+        second.load(path);
+        auto result = second.solve();
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.pushes == 7);
+        CHECK(result.nodes == first.solve().nodes);
+        CHECK(replays(two_boxes, result.solution));
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("should resume a parallel search from a checkpoint") {
+        const std::string path = "solver_test.checkpoint";
+        Solver::Options options;
+        options.node_limit = 4;
+        options.threads = 2;
+        options.checkpoint = path;
+
+        Solver first(two_boxes);
+        first.solve(options);
+
+        Solver second(two_boxes);
+        second.load(path);
+        options.node_limit = 0;
+        auto result = second.solve(options);
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.pushes == 7);
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("should reject a checkpoint for another level") {
+        const std::string path = "solver_test.checkpoint";
+        Solver::Options options;
+        options.node_limit = 1;
+        options.checkpoint = path;
+
+        Solver first(two_boxes);
+        first.solve(options);
+
+        Solver other({
+            "#######",
+            "#     #",
+            "# $ $ #",
+            "#  @ .#",
+            "#   . #",
+            "#######",
+        });
+        CHECK_THROWS_AS(other.load(path), std::invalid_argument);
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("should reject a corrupt checkpoint and keep its search") {
+        const std::string path = "solver_test.checkpoint";
+        Solver::Options options;
+        options.node_limit = 3;
+        options.checkpoint = path;
+
+        Solver first(two_boxes);
+        first.solve(options);
+        std::ifstream in(path, std::ios::binary);
+        const std::string saved{std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>()};
+        in.close();
+
+        // The header takes 40 bytes, ending with the node count, and each
+        // node of this level 21: the player, two boxes, then the parent
+        const auto corrupted = [&](size_t offset, char byte) {
+            std::string data = saved;
+            data[offset] = byte;
+            std::ofstream(path, std::ios::binary) << data;
+        };
+        Solver second(two_boxes);
+
+        corrupted(39, '\x7f');
+        CHECK_THROWS_AS(second.load(path), std::invalid_argument);
+        corrupted(64, '\x7f');
+        CHECK_THROWS_AS(second.load(path), std::invalid_argument);
+        corrupted(70, '\x7f');
+        CHECK_THROWS_AS(second.load(path), std::invalid_argument);
+        corrupted(67, '\x01');
+        CHECK_THROWS_AS(second.load(path), std::invalid_argument);
+        std::ofstream(path, std::ios::binary) << saved.substr(0, 100);
+        CHECK_THROWS_AS(second.load(path), std::invalid_argument);
+
+        const auto result = second.solve();
+        CHECK(result.status == Solver::SOLVED);
+        CHECK(result.pushes == 7);
+        std::remove(path.c_str());
+    }
+
+    TEST_CASE("should resume from a save interrupted before its rename") {
+        const std::string path = "solver_test.checkpoint";
+        Solver::Options options;
+        options.node_limit = 3;
+        options.checkpoint = path;
+
+        Solver first(two_boxes);
+        first.solve(options);
+        std::rename(path.c_str(), (path + ".tmp").c_str());
+
+        Solver second(two_boxes);
+        CHECK_NOTHROW(second.load(path));
+        CHECK(second.solve().nodes == first.solve().nodes);
+        std::remove((path + ".tmp").c_str());
+    }
+
+    TEST_CASE("should time the search phases only in instrumented builds") {
+        Solver solver(two_boxes);
+        CHECK(solver.solve().status == Solver::SOLVED);
+        const Solver::Stats stats = solver.stats();
+
+        if constexpr (instrumented) {
+            CHECK(stats.select.count() > 0);
+            CHECK(stats.generate.count() > 0);
+            CHECK(stats.expand.count() > 0);
+        }
+        else {
+            CHECK(stats.select.count() == 0);
+            CHECK(stats.generate.count() == 0);
+            CHECK(stats.expand.count() == 0);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#include <string>
+
+#include "doctest.h"
+#include "../../src/engine/solver.hpp"
+#include "../../src/engine/trace.hpp"
+
+namespace {
+
+unsigned int count(const std::string &text, const std::string &word) {
+    unsigned int found = 0;
+
+    for (size_t at = text.find(word); at != std::string::npos;
+         at = text.find(word, at + 1)) {
+        found++;
+    }
+
+    return found;
+}
+
+}
+
+TEST_SUITE("Test cases for Trace") {
+
+    TEST_CASE("should record spans only while started") {
+        {
+            Trace::Scope before("before", "test");
+        }
+
+        Trace::start();
+        {
+            Trace::Scope span("span", "test");
+            span.arg("answer", 42);
+        }
+        Trace::stop();
+        {
+            Trace::Scope after("after", "test");
+        }
+
+        const std::string json = Trace::json();
+        CHECK(json.find("\"traceEvents\": [") != std::string::npos);
+        CHECK(count(json, "\"before\"") == 0);
+        CHECK(count(json, "\"after\"") == 0);
+
+        if constexpr (instrumented) {
+            CHECK(count(json, "\"name\": \"span\"") == 1);
+            CHECK(count(json, "\"ph\": \"X\"") == 1);
+            CHECK(count(json, "\"args\": {\"answer\": 42}") == 1);
+        }
+        else {
+            CHECK(count(json, "\"name\"") == 0);
+        }
+    }
+
+    TEST_CASE("should drop events past its capacity") {
+        Trace::start(2);
+
+        for (unsigned int i = 0; i < 3; i++) {
+            Trace::Scope span("span", "test");
+        }
+
+        Trace::stop();
+        const std::string json = Trace::json();
+
+        if constexpr (instrumented) {
+            CHECK(count(json, "\"name\": \"span\"") == 2);
+            CHECK(count(json, "\"dropped\": 1") == 1);
+        }
+        else {
+            CHECK(count(json, "\"name\"") == 0);
+        }
+    }
+
+    TEST_CASE("should trace a solve's preprocessing and iterations") {
+        Trace::start();
+        {
+            Solver solver({
+                "#######",
+                "#     #",
+                "# $$  #",
+                "#  @ .#",
+                "#   . #",
+                "#######",
+            });
+            CHECK(solver.solve().status == Solver::SOLVED);
+        }
+        Trace::stop();
+        const std::string json = Trace::json();
+
+        if constexpr (instrumented) {
+            CHECK(count(json, "\"name\": \"preprocess\"") == 1);
+            CHECK(count(json, "\"name\": \"dead squares\"") == 1);
+            CHECK(count(json, "\"name\": \"solve\"") == 1);
+            CHECK(count(json, "\"name\": \"iteration\"") >= 1);
+            CHECK(count(json, "\"deadlocks\": ") >= 1);
+        }
+        else {
+            CHECK(count(json, "\"name\"") == 0);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/undo_tree.hpp"
+
+TEST_SUITE("Test cases for UndoTree") {
+
+    TEST_CASE("should reuse a child for a move made again") {
+        UndoTree tree;
+        const unsigned int right =
+            tree.child(UndoTree::root, {'R', true, true});
+        const unsigned int up = tree.child(UndoTree::root, {'U', false, true});
+        CHECK(right != up);
+        CHECK(tree.child(UndoTree::root, {'R', true, false}) == right);
+        CHECK(tree[right].step.fast_forward);
+        CHECK(tree[up].depth == 1);
+        const std::vector<unsigned int> children = {right, up};
+        CHECK(tree.children(UndoTree::root) == children);
+        CHECK(tree.size() == 3);
+        tree.clear();
+        CHECK(tree.size() == 1);
+        CHECK(tree.children(UndoTree::root).empty());
+    }
+
+    TEST_CASE("should find the common ancestor of two lines") {
+        UndoTree tree;
+        const unsigned int a = tree.child(UndoTree::root, {'D', false, true});
+        const unsigned int b = tree.child(a, {'D', false, true});
+        const unsigned int c = tree.child(b, {'L', false, true});
+        const unsigned int d = tree.child(a, {'R', false, true});
+        CHECK(tree.common_ancestor(c, d) == a);
+        CHECK(tree.common_ancestor(d, c) == a);
+        CHECK(tree.common_ancestor(b, c) == b);
+        CHECK(tree.common_ancestor(c, c) == c);
+        CHECK(tree.common_ancestor(UndoTree::root, d) == UndoTree::root);
+    }
+}
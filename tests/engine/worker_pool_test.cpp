@@ -0,0 +1,55 @@
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+#include "../../src/engine/worker_pool.hpp"
+
+TEST_SUITE("Test cases for WorkerPool") {
+
+    TEST_CASE("should run a job once on every worker") {
+        WorkerPool pool(4);
+        REQUIRE(pool.size() == 4);
+        std::vector<unsigned int> calls(pool.size());
+        std::vector<std::thread::id> ids(pool.size());
+        pool.run([&](unsigned int worker) {
+            calls[worker]++;
+            ids[worker] = std::this_thread::get_id();
+        });
+
+        CHECK(calls == std::vector<unsigned int>(4, 1));
+        CHECK(ids[0] == std::this_thread::get_id());
+        CHECK(std::set<std::thread::id>(ids.begin(), ids.end()).size() == 4);
+    }
+
+    TEST_CASE("should keep its threads from one run to the next") {
+        WorkerPool pool(3);
+        std::vector<std::thread::id> first(pool.size());
+        std::vector<std::thread::id> later(pool.size());
+        std::atomic<unsigned long> total{0};
+        pool.run([&](unsigned int worker) {
+            first[worker] = std::this_thread::get_id();
+        });
+
+        for (unsigned int run = 0; run < 1000; run++) {
+            pool.run([&](unsigned int worker) {
+                later[worker] = std::this_thread::get_id();
+                total += worker + 1;
+            });
+        }
+
+        CHECK(later == first);
+        CHECK(total == 1000 * (1 + 2 + 3));
+    }
+
+    TEST_CASE("should run serially with one worker") {
+        WorkerPool pool(1);
+        unsigned int calls = 0;
+        pool.run([&](unsigned int worker) {
+            calls += worker + 1;
+        });
+        CHECK(pool.size() == 1);
+        CHECK(calls == 1);
+    }
+}
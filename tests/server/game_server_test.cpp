@@ -0,0 +1,233 @@
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "doctest.h"
+#include "../../src/server/game_client.hpp"
+#include "../../src/server/game_server.hpp"
+
+TEST_SUITE("Test cases for GameServer") {
+
+    const std::vector<std::vector<std::string>> boards = {
+        {"######", "#@$ .#", "######"},
+        {"#####", "#@$.#", "#####"},
+    };
+
+    const std::string path =
+        "/tmp/sokoban-test-" + std::to_string(getpid()) + ".sock";
+
+    /**
+     * Run a server on a temporary socket for the length of a test
+    */
+    struct Running {
+        GameServer server;
+        std::thread thread;
+
+        Running(unsigned int threads, size_t output_limit = 1 << 20)
+            : server(std::make_shared<const LevelStore>(boards),
+                {path, threads, output_limit}),
+              thread([this]() { server.run(); }) {
+        }
+
+        ~Running() {
+            server.stop();
+            thread.join();
+        }
+    };
+
+    TEST_CASE("should play a game over the socket") {
+        Running running(2);
+        GameClient client(path);
+        const Protocol::Response created =
+            client.call({Protocol::CREATE, 1, 0, ""});
+        REQUIRE(created.status == Protocol::OK);
+        const unsigned int session = Protocol::get(created.payload, 0, 4);
+
+        const Protocol::Response moved =
+            client.call({Protocol::MOVE, 2, session, "RR"});
+        CHECK(moved.tag == 2);
+        CHECK(Protocol::get(moved.payload, 0, 4) == 2);
+        CHECK(Protocol::get(moved.payload, 4, 1) == 1);
+        CHECK(client.call({Protocol::SEQUENCE, 3, session, ""}).payload ==
+            "RR");
+        CHECK(client.call({Protocol::BOARD, 4, session, ""}).payload ==
+            "######\n#  @*#\n######");
+        CHECK(Protocol::get(
+            client.call({Protocol::UNDO, 5, session, ""}).payload, 0, 1));
+        CHECK(Protocol::get(
+            client.call({Protocol::SOLVED, 6, session, ""}).payload, 0, 1)
+            == 0);
+    }
+
+    TEST_CASE("should report its shards without a session") {
+        Running running(3);
+        GameClient client(path);
+        const Protocol::Response shards =
+            client.call({Protocol::SHARDS, 1, 0, ""});
+        REQUIRE(shards.status == Protocol::OK);
+        CHECK(Protocol::get(shards.payload, 0, 4) == 3);
+    }
+
+    TEST_CASE("should answer pipelined requests in order") {
+        Running running(1);
+        GameClient client(path);
+        std::string level;
+        Protocol::put(level, 1, 4);
+
+        for (unsigned int tag = 0; tag < 100; tag++) {
+            client.send({Protocol::CREATE, tag, 0, level});
+        }
+
+        client.flush();
+
+        for (unsigned int tag = 0; tag < 100; tag++) {
+            const Protocol::Response response = client.receive();
+            CHECK(response.tag == tag);
+            CHECK(response.status == Protocol::OK);
+        }
+    }
+
+    TEST_CASE("should keep each connection to its own sessions") {
+        Running running(1);
+        GameClient owner(path);
+        GameClient other(path);
+        const unsigned int session = Protocol::get(
+            owner.call({Protocol::CREATE, 1, 0, ""}).payload, 0, 4);
+        const Protocol::Response response =
+            other.call({Protocol::MOVE, 2, session, "R"});
+        CHECK(response.status == Protocol::ERROR);
+        std::string missing;
+        Protocol::put(missing, 9, 4);
+        CHECK(owner.call({Protocol::LEVEL, 3, session, missing}).status ==
+            Protocol::ERROR);
+        CHECK(owner.call({Protocol::SEQUENCE, 4, session, ""}).status ==
+            Protocol::OK);
+    }
+
+    TEST_CASE("should move a game between connections") {
+        Running running(2);
+        GameClient first(path);
+        GameClient second(path);
+        const unsigned int from = Protocol::get(
+            first.call({Protocol::CREATE, 1, 0, ""}).payload, 0, 4);
+        first.call({Protocol::MOVE, 2, from, "R"});
+        const Protocol::Response saved =
+            first.call({Protocol::SAVE, 3, from, ""});
+        REQUIRE(saved.status == Protocol::OK);
+
+        const unsigned int to = Protocol::get(
+            second.call({Protocol::CREATE, 1, 0, ""}).payload, 0, 4);
+        CHECK(second.call({Protocol::RESTORE, 2, to, saved.payload}).status
+            == Protocol::OK);
+        CHECK(second.call({Protocol::SEQUENCE, 3, to, ""}).payload == "R");
+        CHECK(second.call({Protocol::BOARD, 4, to, ""}).payload ==
+            "######\n# @$.#\n######");
+        CHECK(second.call({Protocol::RESTORE, 5, to, "SOKS"}).status ==
+            Protocol::ERROR);
+    }
+
+    TEST_CASE("should stop reading from a client that doesn't read") {
+        Running running(1, 4096);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        REQUIRE(connect(fd, (sockaddr *) &address, sizeof(address)) == 0);
+
+        // Each request is refused with an error message, so the replies
+        // outgrow the requests
+        std::string requests;
+
+        for (unsigned int tag = 0; tag < 1000; tag++) {
+            Protocol::encode({Protocol::SEQUENCE, tag, 0, ""}, requests);
+        }
+
+        // Once the server stops reading, the socket stays full; a server
+        // that kept reading would take all 16 MiB
+        const size_t most = 16 << 20;
+        size_t sent = 0;
+        bool stalled = false;
+
+        while (!stalled && sent < most) {
+            const ssize_t count = send(fd, requests.data(),
+                requests.size(), MSG_NOSIGNAL);
+
+            if (count > 0) {
+                sent += count;
+                requests.append(requests, 0, count);
+                requests.erase(0, count);
+            }
+            else {
+                REQUIRE(errno == EAGAIN);
+                pollfd writable = {fd, POLLOUT, 0};
+                stalled = poll(&writable, 1, 500) == 0;
+            }
+        }
+
+        CHECK(stalled);
+
+        // Every whole request sent is still answered once the client reads
+        const size_t frame = Protocol::request_header;
+        std::string input;
+        size_t offset = 0;
+        unsigned long answered = 0;
+        Protocol::Response response;
+
+        while (answered < sent / frame) {
+            char buffer[65536];
+            pollfd readable = {fd, POLLIN, 0};
+            REQUIRE(poll(&readable, 1, 5000) == 1);
+            const ssize_t count = read(fd, buffer, sizeof(buffer));
+            REQUIRE(count > 0);
+            input.append(buffer, count);
+
+            while (Protocol::decode(input, offset, response)) {
+                answered++;
+            }
+
+            input.erase(0, offset);
+            offset = 0;
+        }
+
+        CHECK(answered == sent / frame);
+        close(fd);
+    }
+
+    TEST_CASE("should refuse connections while out of descriptors") {
+        Running running(1);
+        GameClient first(path);
+        CHECK(first.call({Protocol::SEQUENCE, 1, 0, ""}).status ==
+            Protocol::ERROR);
+
+        // Descriptors are numbered from the lowest free one, so this
+        // leaves one for the client's socket and none for the server's end
+        rlimit limit;
+        REQUIRE(getrlimit(RLIMIT_NOFILE, &limit) == 0);
+        const int lowest = dup(0);
+        close(lowest);
+        rlimit lowered = limit;
+        lowered.rlim_cur = lowest + 1;
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &lowered) == 0);
+
+        {
+            GameClient refused(path);
+            CHECK_THROWS(refused.call({Protocol::SEQUENCE, 1, 0, ""}));
+        }
+
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &limit) == 0);
+        GameClient later(path);
+        CHECK(later.call({Protocol::SEQUENCE, 2, 0, ""}).status ==
+            Protocol::ERROR);
+        CHECK(first.call({Protocol::SEQUENCE, 3, 0, ""}).status ==
+            Protocol::ERROR);
+    }
+}
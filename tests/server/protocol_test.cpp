@@ -0,0 +1,76 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <stdexcept>
+#include <string>
+
+#include "doctest.h"
+#include "../../src/server/protocol.hpp"
+
+TEST_SUITE("Test cases for Protocol") {
+
+    TEST_CASE("should round-trip requests one frame at a time") {
+        std::string stream;
+        Protocol::encode({Protocol::MOVE, 7, 42, "UUL"}, stream);
+        Protocol::encode({Protocol::BOARD, 8, 42, ""}, stream);
+        CHECK(stream.size() == 2 * Protocol::request_header + 3);
+
+        size_t offset = 0;
+        Protocol::Request request;
+        REQUIRE(Protocol::decode(stream, offset, request));
+        CHECK(request.op == Protocol::MOVE);
+        CHECK(request.tag == 7);
+        CHECK(request.session == 42);
+        CHECK(request.payload == "UUL");
+        REQUIRE(Protocol::decode(stream, offset, request));
+        CHECK(request.op == Protocol::BOARD);
+        CHECK(request.payload == "");
+        CHECK(!Protocol::decode(stream, offset, request));
+        CHECK(offset == stream.size());
+    }
+
+    TEST_CASE("should wait for the rest of a partial frame") {
+        std::string stream;
+        Protocol::encode({Protocol::OK, 3, "#@$.#"}, stream);
+        std::string partial = stream.substr(0, stream.size() - 1);
+        size_t offset = 0;
+        Protocol::Response response;
+        CHECK(!Protocol::decode(partial, offset, response));
+        CHECK(offset == 0);
+        partial += stream.back();
+        REQUIRE(Protocol::decode(partial, offset, response));
+        CHECK(response.tag == 3);
+        CHECK(response.payload == "#@$.#");
+    }
+
+    TEST_CASE("should refuse oversized frames") {
+        std::string stream;
+        Protocol::put(stream, Protocol::max_payload + 1, 4);
+        stream += std::string(Protocol::request_header, '\0');
+        size_t offset = 0;
+        Protocol::Request request;
+        CHECK_THROWS_AS(Protocol::decode(stream, offset, request),
+            std::invalid_argument);
+    }
+
+    TEST_CASE("should refuse ops and statuses it doesn't know") {
+        for (const unsigned int op : {0u, Protocol::SHARDS + 1u, 255u}) {
+            std::string stream;
+            Protocol::put(stream, 0, 4);
+            Protocol::put(stream, op, 1);
+            stream += std::string(8, '\0');
+            size_t offset = 0;
+            Protocol::Request request;
+            CHECK_THROWS_AS(Protocol::decode(stream, offset, request),
+                std::invalid_argument);
+        }
+
+        std::string stream;
+        Protocol::put(stream, 0, 4);
+        Protocol::put(stream, Protocol::ERROR + 1, 1);
+        stream += std::string(4, '\0');
+        size_t offset = 0;
+        Protocol::Response response;
+        CHECK_THROWS_AS(Protocol::decode(stream, offset, response),
+            std::invalid_argument);
+    }
+}
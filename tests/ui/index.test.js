@@ -18,6 +18,12 @@ describe("index.html", () => {
   });
   afterEach(() => page.close());
 
+  // Key presses are queued and the moves drawn on the next frame
+  const press = async key => {
+    await page.keyboard.press(key);
+    await page.evaluate(() => new Promise(requestAnimationFrame));
+  };
+
   describe("home screen", () => {
     beforeEach(async () => {
       await page.goto(baseURL);
@@ -91,7 +97,7 @@ describe("index.html", () => {
       it("should enable the undo button after a successful keyboard move", async () => {
         const undoBtn = await page.$("#undo");
         expect(undoBtn).toBeTruthy();
-        await page.keyboard.press("ArrowRight");
+        await press("ArrowRight");
         expect(await undoBtn.evaluate(el => el.disabled)).toBe(false);
       });
 
@@ -111,7 +117,7 @@ describe("index.html", () => {
       it("should enable the reset button after a successful keyboard move", async () => {
         const resetBtn = await page.$("#reset");
         expect(resetBtn).toBeTruthy();
-        await page.keyboard.press("ArrowRight");
+        await press("ArrowRight");
         expect(await resetBtn.evaluate(el => el.disabled)).toBe(false);
       });
 
@@ -134,29 +140,29 @@ describe("index.html", () => {
 
       it("should allow the player to move right via arrow key on empty floor", async () => {
         const {col: preX} = await playerPos();
-        await page.keyboard.press("ArrowRight");
+        await press("ArrowRight");
         const {col: postX} = await playerPos();
         expect(postX - 1).toEqual(preX);
       });
 
       it("should allow the player to move left via arrow key on empty floor", async () => {
-        await page.keyboard.press("ArrowRight");
+        await press("ArrowRight");
         const {col: preX} = await playerPos();
-        await page.keyboard.press("ArrowLeft");
+        await press("ArrowLeft");
         const {col: postX} = await playerPos();
         expect(postX + 1).toEqual(preX);
       });
 
       it("should allow the player to move up via arrow key on empty floor", async () => {
         const {row: preY} = await playerPos();
-        await page.keyboard.press("ArrowUp");
+        await press("ArrowUp");
         const {row: postY} = await playerPos();
         expect(postY + 1).toEqual(preY);
       });
 
       it("should allow the player to move down via arrow key on empty floor", async () => {
         const {row: preY} = await playerPos();
-        await page.keyboard.press("ArrowDown");
+        await press("ArrowDown");
         const {row: postY} = await playerPos();
         expect(postY - 1).toEqual(preY);
       });
@@ -192,32 +198,32 @@ describe("index.html", () => {
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 0");
         await (await squareAt(6, 7)).click();
-        await page.keyboard.press("ArrowDown");
-        await page.keyboard.press("ArrowDown");
-        await page.keyboard.press("ArrowLeft");
-        await page.keyboard.press("ArrowUp");
-        await page.keyboard.press("ArrowUp");
-        await page.keyboard.press("ArrowUp");
-        await page.keyboard.press("ArrowUp");
-        await page.keyboard.press("ArrowUp");
+        await press("ArrowDown");
+        await press("ArrowDown");
+        await press("ArrowLeft");
+        await press("ArrowUp");
+        await press("ArrowUp");
+        await press("ArrowUp");
+        await press("ArrowUp");
+        await press("ArrowUp");
         await (await squareAt(3, 1)).click();
-        await page.keyboard.press("ArrowUp");
+        await press("ArrowUp");
         await (await squareAt(2, 5)).click();
-        await page.keyboard.press("ArrowRight");
-        await page.keyboard.press("ArrowRight");
+        await press("ArrowRight");
+        await press("ArrowRight");
         await (await squareAt(3, 8)).click();
-        await page.keyboard.press("ArrowUp");
+        await press("ArrowUp");
         await (await squareAt(6, 5)).click();
-        await page.keyboard.press("ArrowDown");
+        await press("ArrowDown");
         await (await squareAt(8, 6)).click();
-        await page.keyboard.press("ArrowLeft");
-        await page.keyboard.press("ArrowLeft");
-        await page.keyboard.press("ArrowLeft");
-        await page.keyboard.press("ArrowLeft");
+        await press("ArrowLeft");
+        await press("ArrowLeft");
+        await press("ArrowLeft");
+        await press("ArrowLeft");
         await (await squareAt(7, 1)).click();
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 47");
-        await page.keyboard.press("ArrowDown");
+        await press("ArrowDown");
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Solved in 48 moves");
       });
@@ -235,10 +241,10 @@ describe("index.html", () => {
       it("should increment moves as they are performed", async () => {
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 0");
-        await page.keyboard.press("ArrowDown");
+        await press("ArrowDown");
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 1");
-        await page.keyboard.press("ArrowUp");
+        await press("ArrowUp");
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 2");
       });
@@ -246,10 +252,10 @@ describe("index.html", () => {
       it("shouldn't increment moves when moving into a wall", async () => {
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 0");
-        await page.keyboard.press("ArrowLeft");
+        await press("ArrowLeft");
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 1");
-        await page.keyboard.press("ArrowLeft");
+        await press("ArrowLeft");
         expect(await page.$eval("#status", el => el.textContent.trim()))
           .toEqual("Moves: 1");
       });
@@ -262,6 +268,59 @@ describe("index.html", () => {
           .toEqual("Moves: 4");
       });
     });
+
+    describe("hint", () => {
+      const status = () =>
+        page.$eval("#status", el => el.textContent.trim())
+      ;
+
+      it("should show the next move from the worker", async () => {
+        await press("KeyH");
+        await page.waitForFunction(
+          () => /^Hint: [udlrUDLR]$/.test(
+            document.querySelector("#status").textContent.trim()
+          ),
+          {timeout: 20000}
+        );
+      });
+
+      it("should keep taking moves while the worker searches", async () => {
+        await press("KeyH");
+        await press("ArrowRight");
+        expect(await status()).toEqual("Moves: 1");
+      });
+    });
   });
-});
 
+  describe("canvas board", () => {
+    // The test level drawn the way large boards are
+    beforeEach(async () => {
+      await page.goto(`${baseURL}/?renderer=canvas#101`, {timeout: 30000});
+      await page.waitForSelector("#board canvas");
+    });
+
+    it("should paint the board instead of building a table", async () => {
+      expect(await page.$("#board table")).toBeNull();
+
+      // The top left wall, once the sprites load
+      await page.waitForFunction(() => {
+        const canvas = document.querySelector("#board canvas");
+        const ratio = window.devicePixelRatio || 1;
+        return canvas.getContext("2d")
+          .getImageData(15 * ratio, 15 * ratio, 1, 1).data[3] > 0;
+      });
+    });
+
+    it("should move with the keyboard", async () => {
+      await press("ArrowRight");
+      expect(await page.$eval("#status", el => el.textContent.trim()))
+        .toEqual("Moves: 1");
+    });
+
+    it("should move to a clicked cell", async () => {
+      const {x, y} = await (await page.$("#board canvas")).boundingBox();
+      await page.mouse.click(x + 3 * 30 + 15, y + 4 * 30 + 15);
+      expect(await page.$eval("#undo", el => el.disabled)).toBe(false);
+    });
+  });
+});
@@ -0,0 +1,73 @@
+const path = require("path");
+const puppeteer = require("puppeteer");
+const serve = require("../../scripts/serve");
+
+// Needs `npm run build:threads`; serves dist itself with the headers for
+// cross-origin isolation
+const port = 8001;
+const baseURL = `http://localhost:${port}/dist`;
+jest.setTimeout(120000);
+
+describe("threaded solver", () => {
+  let browser;
+  let page;
+  let server;
+
+  beforeAll(async () => {
+    server = await serve(path.join(__dirname, "..", ".."), port);
+    browser = await puppeteer.launch({headless: true});
+  });
+  afterAll(async () => {
+    await browser.close();
+    server.close();
+  });
+  beforeEach(async () => {
+    page = await browser.newPage();
+    await page.goto(baseURL);
+    await page.waitForSelector("#menu");
+  });
+  afterEach(() => page.close());
+
+  // Time a first-solution solve of a level that takes a second or two on
+  // one thread
+  const timeSolve = threads => page.evaluate(async threads => {
+    const {default: soko} = await import("./js/soko.js");
+    const {default: solver} = await import("./js/solver.js");
+    soko.changeLevel(20);
+    const board = soko.boardToStr();
+    const start = performance.now();
+    const result = await solver.solve(board, {weight: 3, first: true, threads});
+    return {ms: performance.now() - start, status: result.status};
+  }, threads);
+
+  it("should load the threaded build on an isolated page", async () => {
+    expect(await page.evaluate(() => crossOriginIsolated)).toBe(true);
+    const info = await page.evaluate(async () => {
+      const {default: solver} = await import("./js/solver.js");
+      return solver.info();
+    });
+    expect(info.threads).toEqual(
+      await page.evaluate(() => navigator.hardwareConcurrency)
+    );
+  });
+
+  it("should solve faster with a thread per core", async () => {
+    const cores = await page.evaluate(() => navigator.hardwareConcurrency);
+
+    // Warm up the worker and its pthread pool
+    await timeSolve(1);
+    const serial = await timeSolve(1);
+    const parallel = await timeSolve(cores);
+    expect(serial.status).toEqual("solved");
+    expect(parallel.status).toEqual("solved");
+    console.log(
+      `${cores} threads: ${parallel.ms.toFixed(0)} ms, ` +
+      `1 thread: ${serial.ms.toFixed(0)} ms, ` +
+      `speedup ${(serial.ms / parallel.ms).toFixed(2)}x`
+    );
+
+    if (cores > 1) {
+      expect(serial.ms / parallel.ms).toBeGreaterThan(1.2);
+    }
+  });
+});